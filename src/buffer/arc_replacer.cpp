@@ -0,0 +1,198 @@
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+ARCReplacer::ARCReplacer(size_t num_pages) : max_size(num_pages), frames_(num_pages) {}
+
+ARCReplacer::~ARCReplacer() = default;
+
+// REPLACE of ARC: T1 gives up a frame as long as it is larger than its target size.
+bool ARCReplacer::PreferT1() const { return !t1_.empty() && (t1_.size() > target_t1_ || t2_.empty()); }
+
+frame_id_t ARCReplacer::FindEvictable(const std::list<frame_id_t> &list) const {
+  // the pinned frames stay in their list, they are skipped.
+  for (auto iter = list.rbegin(); iter != list.rend(); iter++) {
+    if (frames_[*iter].evictable_) {
+      return *iter;
+    }
+  }
+  return INVALID_FRAME_ID;
+}
+
+bool ARCReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock{mutx_};
+  if (num_evictable_ == 0) {
+    return false;
+  }
+  bool prefer_t1 = PreferT1();
+  frame_id_t victim = FindEvictable(prefer_t1 ? t1_ : t2_);
+  if (victim == INVALID_FRAME_ID) {
+    victim = FindEvictable(prefer_t1 ? t2_ : t1_);
+  }
+  if (victim == INVALID_FRAME_ID) {
+    return false;
+  }
+  Evict(victim);
+  *frame_id = victim;
+  return true;
+}
+
+// the frame stays in its list, it can not be seen by the victim selection.
+void ARCReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock{mutx_};
+  if (static_cast<size_t>(frame_id) >= max_size || !frames_[frame_id].evictable_) {
+    return;
+  }
+  frames_[frame_id].evictable_ = false;
+  num_evictable_--;
+}
+
+// an access of the page: it moves to the most recently used end of T2, unless it has just been loaded.
+void ARCReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock{mutx_};
+  // out of range, or already evictable (avoid the repeated addition of the element)
+  if (static_cast<size_t>(frame_id) >= max_size || frames_[frame_id].evictable_) {
+    return;
+  }
+  FrameState &frame = frames_[frame_id];
+  if (frame.list_ == kNone) {
+    if (frame.has_page_) {
+      // chosen as a victim, but kept by the buffer pool because it was pinned again. The page is back.
+      auto ghost = ghosts_.find(frame.page_key_);
+      if (ghost != ghosts_.end()) {
+        EraseGhost(ghost);
+      }
+      Attach(frame_id, kT2);
+    } else {
+      // the page was not announced by OnLoad, it is a new page.
+      Attach(frame_id, kT1);
+    }
+  } else if (frame.fresh_) {
+    frame.fresh_ = false;
+  } else {
+    Detach(frame_id);
+    Attach(frame_id, kT2);
+  }
+  frame.evictable_ = true;
+  num_evictable_++;
+}
+
+size_t ARCReplacer::Size() {
+  std::scoped_lock lock{mutx_};
+  return num_evictable_;
+}
+
+// the victims are taken from the least recently used end of the preferred list first.
+void ARCReplacer::PeekVictims(std::vector<frame_id_t> *frames, size_t max_num) {
+  std::scoped_lock lock{mutx_};
+  bool prefer_t1 = PreferT1();
+  for (const std::list<frame_id_t> *list : {prefer_t1 ? &t1_ : &t2_, prefer_t1 ? &t2_ : &t1_}) {
+    for (auto iter = list->rbegin(); iter != list->rend() && frames->size() < max_num; iter++) {
+      if (frames_[*iter].evictable_) {
+        frames->push_back(*iter);
+      }
+    }
+  }
+}
+
+void ARCReplacer::OnLoad(frame_id_t frame_id, uint64_t page_key) {
+  std::scoped_lock lock{mutx_};
+  if (static_cast<size_t>(frame_id) >= max_size) {
+    return;
+  }
+  FrameState &frame = frames_[frame_id];
+  if (frame.list_ != kNone) {
+    // the frame was taken without Victim (e.g. recycled by the ring of a bulk read), its page is evicted now.
+    Evict(frame_id);
+  }
+  frame.has_page_ = true;
+  frame.page_key_ = page_key;
+  frame.fresh_ = true;
+  auto ghost = ghosts_.find(page_key);
+  if (ghost == ghosts_.end()) {
+    Attach(frame_id, kT1);
+  } else if (ghost->second.in_b1_) {
+    // evicted from T1 too early, T1 grows.
+    target_t1_ = std::min(max_size, target_t1_ + std::max<size_t>(1, b2_.size() / b1_.size()));
+    EraseGhost(ghost);
+    Attach(frame_id, kT2);
+  } else {
+    // evicted from T2 too early, T2 grows.
+    size_t delta = std::max<size_t>(1, b1_.size() / b2_.size());
+    target_t1_ = target_t1_ > delta ? target_t1_ - delta : 0;
+    EraseGhost(ghost);
+    Attach(frame_id, kT2);
+  }
+  TrimGhosts();
+}
+
+// a deleted page is not remembered, it will not come back.
+void ARCReplacer::OnDrop(frame_id_t frame_id) {
+  std::scoped_lock lock{mutx_};
+  if (static_cast<size_t>(frame_id) >= max_size) {
+    return;
+  }
+  FrameState &frame = frames_[frame_id];
+  Detach(frame_id);
+  if (frame.evictable_) {
+    frame.evictable_ = false;
+    num_evictable_--;
+  }
+  frame.has_page_ = false;
+  frame.fresh_ = false;
+}
+
+size_t ARCReplacer::GetTargetSize() {
+  std::scoped_lock lock{mutx_};
+  return target_t1_;
+}
+
+void ARCReplacer::Evict(frame_id_t frame_id) {
+  FrameState &frame = frames_[frame_id];
+  bool from_t1 = frame.list_ == kT1;
+  Detach(frame_id);
+  if (frame.evictable_) {
+    frame.evictable_ = false;
+    num_evictable_--;
+  }
+  if (frame.has_page_) {
+    std::list<uint64_t> &ghost_list = from_t1 ? b1_ : b2_;
+    ghost_list.push_front(frame.page_key_);
+    ghosts_[frame.page_key_] = GhostEntry{from_t1, ghost_list.begin()};
+  }
+}
+
+void ARCReplacer::Detach(frame_id_t frame_id) {
+  FrameState &frame = frames_[frame_id];
+  if (frame.list_ == kT1) {
+    t1_.erase(frame.pos_);
+  } else if (frame.list_ == kT2) {
+    t2_.erase(frame.pos_);
+  }
+  frame.list_ = kNone;
+}
+
+void ARCReplacer::Attach(frame_id_t frame_id, ListType list) {
+  FrameState &frame = frames_[frame_id];
+  std::list<frame_id_t> &target = list == kT1 ? t1_ : t2_;
+  target.push_front(frame_id);
+  frame.pos_ = target.begin();
+  frame.list_ = list;
+}
+
+void ARCReplacer::EraseGhost(std::unordered_map<uint64_t, GhostEntry>::iterator iter) {
+  (iter->second.in_b1_ ? b1_ : b2_).erase(iter->second.pos_);
+  ghosts_.erase(iter);
+}
+
+void ARCReplacer::TrimGhosts() {
+  while (t1_.size() + b1_.size() > max_size && !b1_.empty()) {
+    ghosts_.erase(b1_.back());
+    b1_.pop_back();
+  }
+  while (t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * max_size && !(b1_.empty() && b2_.empty())) {
+    std::list<uint64_t> &ghost_list = b2_.empty() ? b1_ : b2_;
+    ghosts_.erase(ghost_list.back());
+    ghost_list.pop_back();
+  }
+}
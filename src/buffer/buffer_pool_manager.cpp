@@ -1,29 +1,72 @@
 #include "buffer/buffer_pool_manager.h"
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
 // ctors have already been given
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager) {
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size_);
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, ReplacerType replacer_type,
+                                     size_t max_pool_size)
+    : pool_size_(pool_size),
+      pages_(std::max(pool_size, max_pool_size)),
+      disk_manager_(disk_manager),
+      frame_tags_(pages_.GetMaxFrames(), 0) {
+  pages_.Grow(pool_size_);
+  if (disk_manager_ != nullptr) {
+    disk_managers_[0] = disk_manager_;
+  }
+  // the replacer knows all the frames the pool can grow to.
+  size_t max_frames = pages_.GetMaxFrames();
+  switch (replacer_type) {
+    case kReplacerLRUK:
+      replacer_ = new LRUKReplacer(max_frames);
+      break;
+    case kReplacerClock:
+      replacer_ = new ClockReplacer(max_frames);
+      break;
+    case kReplacerARC:
+      replacer_ = new ARCReplacer(max_frames);
+      break;
+    case kReplacerLRU:
+    default:
+      replacer_ = new LRUReplacer(max_frames);
+      break;
+  }
   for (size_t i = 0; i < pool_size_; i++) {
     // initial state: all the pages in the buffer frame is free.
-    // push them all into the free list.
+    // push them all into the free list. A free frame can not be pinned by the hit path.
+    pages_[i].pin_count_ = Page::FRAME_NOT_RESIDENT;
     free_list_.emplace_back(i);
   }
 }
 
+BufferPoolManager::BufferPoolManager(DiskManager *disk_manager)
+    : pool_size_(0), pages_(0), disk_manager_(disk_manager), replacer_(nullptr) {
+  if (disk_manager_ != nullptr) {
+    disk_managers_[0] = disk_manager_;
+  }
+}
+
 BufferPoolManager::~BufferPoolManager() {
-  for (auto page : page_table_) {
-    // flush all the memory pages into the physical storage(disk)
-    FlushPage(page.first);  // page is a tuple <page_id_t, frame_id_t> -> page.first get the page_id_t of the mapping.
+  stop_prefetcher();
+  StopBackgroundFlusher();
+  // flush all the memory pages into the physical storage(disk)
+  for (auto &entry : disk_managers_) {
+    flush_all_pages(entry.first);
   }
-  delete[] pages_;
   delete replacer_;  // call the dtor function of the object replacer_ pointing to.
 }
 
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+Page *BufferPoolManager::FetchPage(page_id_t page_id) { return fetch_page(0, page_id, nullptr); }
+
+Page *BufferPoolManager::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return fetch_page(0, page_id, strategy);
+}
+
+Page *BufferPoolManager::fetch_page(uint32_t tag, page_id_t page_id, BufferAccessStrategy *strategy) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -31,79 +74,161 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+
+  // hit path: no latch_, only the shared latch of one page table stripe. The replacer is not told here, the frame
+  // is marked as referenced and the replacer is updated when the page is unpinned (or skipped by the victim search).
+  PageKey key = MakePageKey(tag, page_id);
+  Page *hit_page = nullptr;
+  page_table_.Find(key, [&](frame_id_t frame_id) {
+    if (try_pin_page(&pages_[frame_id])) {
+      hit_page = &pages_[frame_id];
+    }
+  });
+  if (hit_page != nullptr) {
+    fetch_hits_.fetch_add(1, std::memory_order_relaxed);
+    return hit_page;
+  }
+
+  // slow path: the page is not resident, or its frame is being replaced right now.
   std::scoped_lock lock{latch_};
-  auto search_page = page_table_.find(page_id);
-  if (search_page != page_table_.end()) {
-    // this page exists in the page_table_ (this page is in the buffer pool)
-    frame_id_t frame_id = search_page->second;
+  frame_id_t frame_id = -1;
+  if (page_table_.Find(key, &frame_id)) {
+    // this page exists in the page_table_ (loaded by another thread in the meantime)
     Page *page = &(pages_[frame_id]);  // get the specified page in the buffer pool
     replacer_->Pin(frame_id);          // pin it, so it can not be replaced by the LRU algorithm
     page->pin_count_++;                // after the pin of LRU replacer, need to refresh the pin_count_ label.
+    fetch_hits_.fetch_add(1, std::memory_order_relaxed);
     return page;                       // return the page fetched from the memory to the executor.
-  } else {                             // this page is not in the buffer pool, in the disk
-    frame_id_t frame_id = -1;
-    // use the self-defined function find_victim_page to find the victim page from 2 case
-    // -> free_list_ or LRU replacer's advice.
-    if (!find_victim_page(&frame_id)) {  // no replacement solution, fetching fails.
-      return nullptr;
-    }
-    // the victim page has been found, now replace the data with the page's content.
-    Page *page = &(pages_[frame_id]);
-    update_page(page, page_id, frame_id);
-    // clear the data to be zero. If the page is dirty, write it into disk, and then set dirty to be false. Clear the
-    // data to be zero as well.
-    disk_manager_->ReadPage(page_id, page->data_);  // read the database file (page_id position) to new page->data
-    replacer_->Pin(frame_id);                       // pin the new data read in
-    page->pin_count_ = 1;  // "++" is OK, but here is equal to create a page, so "= 1" is better. Cause this page is
-                           // loaded from the disk(new to memory), therefore, just set the pin_count to be 1.
-    // actually, every time we read a disk page into memory, only the data_ will be read, the other infomations are
-    // created again. is_Dirty_ is defaultly set to be false, here no need to change it. -> The page is already Pin
-    return page;
   }
+  fetch_misses_.fetch_add(1, std::memory_order_relaxed);
+  // this page is not in the buffer pool, in the disk
+  // use the self-defined function find_victim_page to find the victim page from 2 case
+  // -> free_list_ or LRU replacer's advice.
+  // a bulk read recycles the frames of its ring instead.
+  if (!find_victim_page(&frame_id, strategy)) {  // no replacement solution, fetching fails.
+    pin_wait_failures_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  // the victim page has been found, now replace the data with the page's content.
+  Page *page = &(pages_[frame_id]);
+  update_page(page, tag, page_id, frame_id);
+  remember_page(strategy, tag, page_id);
+  // clear the data to be zero. If the page is dirty, write it into disk, and then set dirty to be false. Clear the
+  // data to be zero as well.
+  DiskManager *disk_manager = get_disk_manager(tag);
+  const char *mapped = disk_manager->GetMappedPage(page_id);
+  if (mapped != nullptr) {
+    // a page of a read only mapped db file is used in place, the page cache of the kernel is the only copy.
+    page->data_ = const_cast<char *>(mapped);
+  } else {
+    disk_manager->ReadPage(page_id, page->data_);  // read the database file (page_id position) to new page->data
+  }
+  replacer_->Pin(frame_id);                       // pin the new data read in
+  page->referenced_ = false;
+  page->pin_count_ = 1;  // "++" is OK, but here is equal to create a page, so "= 1" is better. Cause this page is
+                         // loaded from the disk(new to memory), therefore, just set the pin_count to be 1.
+                         // Set at last, the hit path can pin the frame from now on.
+  // actually, every time we read a disk page into memory, only the data_ will be read, the other infomations are
+  // created again. is_Dirty_ is defaultly set to be false, here no need to change it. -> The page is already Pin
+  return page;
 }
 
-Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+bool BufferPoolManager::try_pin_page(Page *page) {
+  int pin_count = page->pin_count_.load();
+  while (pin_count >= 0) {
+    if (page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1)) {
+      if (!page->referenced_.load(std::memory_order_relaxed)) {
+        page->referenced_.store(true, std::memory_order_relaxed);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+Page *BufferPoolManager::NewPage(page_id_t &page_id) { return new_page(0, page_id, nullptr); }
+
+Page *BufferPoolManager::NewPage(page_id_t &page_id, BufferAccessStrategy *strategy) {
+  return new_page(0, page_id, strategy);
+}
+
+Page *BufferPoolManager::NewPageNear(page_id_t &page_id, page_id_t near_page_id) {
+  return new_page(0, page_id, nullptr, near_page_id);
+}
+
+Page *BufferPoolManager::new_page(uint32_t tag, page_id_t &page_id, BufferAccessStrategy *strategy,
+                                  page_id_t near_page_id) {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
   std::scoped_lock lock{latch_};
+  if (get_disk_manager(tag)->IsReadOnly()) {
+    return nullptr;
+  }
   frame_id_t frame_id = -1;
   // case 1: can not get victim frame_id, the new page operation fails.
-  if (!find_victim_page(&frame_id)) {
+  if (!find_victim_page(&frame_id, strategy)) {
+    pin_wait_failures_.fetch_add(1, std::memory_order_relaxed);
     return nullptr;
   }
   // case 2: got victim frame_id
-  page_id = AllocatePage();          // allocate a new disk page_id, change the argument page_id.
+  page_id = AllocatePage(tag, near_page_id);  // allocate a new disk page_id, change the argument page_id.
   Page *page = &(pages_[frame_id]);  // get buffer pool page from the frame_id
-  page->pin_count_ = 1;  // set the pin_count_ to be 1 when a new disk page is loaded into memory buffer pool.f
-  update_page(page, page_id,
+  update_page(page, tag, page_id,
               frame_id);     // update the page content to be the disk_page -> page_id, and buffer pool_page -> frame_id
+  remember_page(strategy, tag, page_id);
   replacer_->Pin(frame_id);  // pin the new updated frame_id when a new disk page has just been put into the memory
- 
+  page->referenced_ = false;
+  page->pin_count_ = 1;  // set the pin_count_ to be 1 when a new disk page is loaded into memory buffer pool.
+  new_pages_.fetch_add(1, std::memory_order_relaxed);
 
   return page;
 }
 
+Page *BufferPoolManager::NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy, uint32_t tag) {
+  std::scoped_lock lock{latch_};
+  frame_id_t frame_id = -1;
+  if (!find_victim_page(&frame_id, strategy)) {
+    pin_wait_failures_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  Page *page = &(pages_[frame_id]);
+  update_page(page, tag, page_id, frame_id);
+  remember_page(strategy, tag, page_id);
+  replacer_->Pin(frame_id);
+  page->referenced_ = false;
+  page->pin_count_ = 1;
+  new_pages_.fetch_add(1, std::memory_order_relaxed);
+  return page;
+}
+
+bool BufferPoolManager::DeletePage(page_id_t page_id) { return delete_page(0, page_id); }
+
 // here the page_id is the disk page id -> also the key of hash table
-bool BufferPoolManager::DeletePage(page_id_t page_id) {
+bool BufferPoolManager::delete_page(uint32_t tag, page_id_t page_id) {
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
   std::scoped_lock lock{latch_};
-  auto search = page_table_.find(page_id);
+  if (get_disk_manager(tag)->IsReadOnly()) {
+    return false;
+  }
+  write_back_epoch_++;  // a read-ahead of this page must not put it back.
+  frame_id_t frame_id = -1;
   // case 1: the page does not exist, just return true.
-  if (search == page_table_.end()) {
+  if (!page_table_.Find(MakePageKey(tag, page_id), &frame_id)) {
     return true;
   }
   // case 2: normal case, the page exists in the buffer pool
-  frame_id_t frame_id = search->second;
   Page *page = &(pages_[frame_id]);
   // case 2.1: the page is still used by some thread, can not delete
-  if (page->pin_count_ > 0) {
+  // pin_count_ 0 -> FRAME_NOT_RESIDENT, so that the hit path can not pin it any more.
+  int unpinned = 0;
+  if (!page->pin_count_.compare_exchange_strong(unpinned, Page::FRAME_NOT_RESIDENT)) {
     return false;
   }
   // case 2.2: pin_count_ == 0, can be deleted
@@ -112,65 +237,96 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
     cout << "fuck " << i << " times" << endl;
     i++;
   }*/
-  DeallocatePage(page_id);                       // deallocate the corresponding disk file
-  update_page(page, INVALID_PAGE_ID, frame_id);  // set the page's disk page to INVALID value.
+  DeallocatePage(page_id, tag);                       // deallocate the corresponding disk file
+  mark_clean(page);                                   // the page is dropped, no need to write it back.
+  update_page(page, tag, INVALID_PAGE_ID, frame_id);  // set the page's disk page to INVALID value.
+  replacer_->Pin(frame_id);                      // the free frame should not be chosen by the replacer.
   free_list_.push_back(frame_id);                // add the free frame page to tail of the free list.
+  deleted_pages_.fetch_add(1, std::memory_order_relaxed);
 
   return true;
 }
 
-// the page_id argument is the disk page id.
-bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-  std::scoped_lock lock{latch_};
-  auto search = page_table_.find(page_id);
-  // case 1: the page doesn't exist in the buffer
-  if (search == page_table_.end()) {
-    return false;
-  }
-
-  // case 2: the page exist in the page table
-  frame_id_t frame_id = search->second;
-  Page *page = &(pages_[frame_id]);
-  // case 2.1: if the pin_count_ = 0; -> the page has not been pinned before
-  if (page->pin_count_ == 0) {
-    return false;
-  }
+bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) { return unpin_page(0, page_id, is_dirty); }
 
-  // case 2.2: the pin_count_ > 0
-  page->pin_count_--;
-  if (page->pin_count_ == 0) {
-    // only when the pin_count_ has reduced to 0, can the replacer do the unpin operation!
-    // or some unpin operation will fail because the directly unpin of replacer.
-    // must ensure all the thread and pins work until they are all unpinned. When a page is unpinned in the replacer, it
-    // might be deleted from the buffer pool
-    replacer_->Unpin(frame_id);
-  }
-  if (is_dirty) {
-    page->is_dirty_ = true;  // if the unpinned page is now dirty, then change the page infomation about this page
-    // if the pinned page is not dirty now, do not change it, because it might be dirty originally.
-    // this is not equal to: page->is_dirty_ = is_dirty
-  }
+// the page_id argument is the disk page id.
+// No latch_ needed, the page table stripe latch keeps the frame while the pin count is changed.
+bool BufferPoolManager::unpin_page(uint32_t tag, page_id_t page_id, bool is_dirty) {
+  bool state = false;
+  bool unpinned = false;  // whether the pin_count_ has reduced to 0
+  bool rejected = false;  // a dirty unpin of a page of a read only db file
+  frame_id_t frame_id = -1;
+  page_table_.Find(MakePageKey(tag, page_id), [&](frame_id_t found) {
+    frame_id = found;
+    Page *page = &(pages_[frame_id]);
+    int pin_count = page->pin_count_.load();
+    // case 2.1: if the pin_count_ = 0; -> the page has not been pinned before
+    if (pin_count <= 0) {
+      return;
+    }
+    // a mapped page can not be changed, the db file is read only: the page is unpinned, but the unpin fails.
+    if (is_dirty && page->IsMapped()) {
+      rejected = true;
+    } else if (is_dirty) {
+      mark_dirty(page);  // if the unpinned page is now dirty, then change the page infomation about this page
+      // if the pinned page is not dirty now, do not change it, because it might be dirty originally.
+      // this is not equal to: page->is_dirty_ = is_dirty
+      // set before the pin_count_ decreases, the page can be written back as soon as it is unpinned.
+    }
+    // case 2.2: the pin_count_ > 0
+    while (pin_count > 0 && !page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+    }
+    state = pin_count > 0;
+    unpinned = pin_count == 1;
+    // case 1: the page doesn't exist in the buffer
+    if (unpinned) {
+      // only when the pin_count_ has reduced to 0, can the replacer do the unpin operation!
+      // or some unpin operation will fail because the directly unpin of replacer.
+      // must ensure all the thread and pins work until they are all unpinned. When a page is unpinned in the replacer,
+      // it might be deleted from the buffer pool
+      // Still under the latch of the stripe: the frame can not be dropped by Resize in the meantime.
+      if (page->referenced_.exchange(false)) {
+        // pinned by the hit path, which did not tell the replacer. Refresh the position of the frame in the replacer.
+        replacer_->Pin(frame_id);
+      }
+      replacer_->Unpin(frame_id);
+    }
+  });
 
-  return true;
+  return state && !rejected;
 }
 
-void BufferPoolManager::update_page(Page *page, page_id_t new_page_id, frame_id_t new_frame_id) {
+void BufferPoolManager::update_page(Page *page, uint32_t new_tag, page_id_t new_page_id, frame_id_t new_frame_id) {
+  uint32_t old_tag = frame_tags_[new_frame_id];
   // step 1: if it is dirty -> write it back to disk, and set dirty to false.
   if (page->IsDirty()) {
-    disk_manager_->WritePage(page->page_id_, page->data_);
-    page->is_dirty_ = false;
+    get_disk_manager(old_tag)->WritePage(page->page_id_, page->data_);
+    mark_clean(page);
+    write_back_epoch_++;
+    dirty_write_backs_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (page->page_id_ != INVALID_PAGE_ID && new_page_id != INVALID_PAGE_ID) {
+    evictions_.fetch_add(1, std::memory_order_relaxed);
   }
 
   // step 2: refresh the page table
-  page_table_.erase(page->page_id_);     // delete the page_id and its frame_id in the original page_table_
+  if (page->page_id_ != INVALID_PAGE_ID) {
+    // delete the page_id and its frame_id in the original page_table_
+    page_table_.Erase(MakePageKey(old_tag, page->page_id_));
+  }
   if (new_page_id != INVALID_PAGE_ID) {  // the object contains a physical page. If INVALID_PAGE_ID, then do not add it
                                          // to the page_table_
-    page_table_.emplace(new_page_id, new_frame_id);  // add new page_id and the corresponding frame_id into page_table_
+    // add new page_id and the corresponding frame_id into page_table_
+    page_table_.Insert(MakePageKey(new_tag, new_page_id), new_frame_id);
+    replacer_->OnLoad(new_frame_id, MakePageKey(new_tag, new_page_id));
+  } else {
+    replacer_->OnDrop(new_frame_id);
   }
 
   // step 3: reset the data in the page(clear out it to be zero), and page id
   page->ResetMemory();
   page->page_id_ = new_page_id;
+  frame_tags_[new_frame_id] = new_tag;
 }
 
 bool BufferPoolManager::find_victim_page(frame_id_t *frame_id) {
@@ -183,23 +339,74 @@ bool BufferPoolManager::find_victim_page(frame_id_t *frame_id) {
     return true;
   }
   // case 2: the buffer pool is already full, need to call LRU replacer.
-  return replacer_->Victim(frame_id);
+  // The hit path may have pinned the frame after it was put into the replacer, or the frame may be free already:
+  // such frames fail to change pin_count_ 0 -> FRAME_NOT_RESIDENT and are skipped. They are given back to the
+  // replacer when they are unpinned.
+  while (replacer_->Victim(frame_id)) {
+    int unpinned = 0;
+    if (pages_[*frame_id].pin_count_.compare_exchange_strong(unpinned, Page::FRAME_NOT_RESIDENT)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BufferPoolManager::find_victim_page(frame_id_t *frame_id, BufferAccessStrategy *strategy) {
+  if (strategy == nullptr) {
+    return find_victim_page(frame_id);
+  }
+  strategy->current_ = (strategy->current_ + 1) % strategy->ring_.size();
+  BufferAccessStrategy::Slot &slot = strategy->ring_[strategy->current_];
+  // recycle the frame of the ring, unless another thread has loaded its own page into it or is using the page.
+  if (slot.owner_ == this && slot.page_id_ != INVALID_PAGE_ID && static_cast<size_t>(slot.frame_id_) < pool_size_ &&
+      pages_[slot.frame_id_].page_id_ == slot.page_id_ &&
+      frame_tags_[slot.frame_id_] == slot.tag_) {
+    int unpinned = 0;
+    if (pages_[slot.frame_id_].pin_count_.compare_exchange_strong(unpinned, Page::FRAME_NOT_RESIDENT)) {
+      replacer_->Pin(slot.frame_id_);
+      *frame_id = slot.frame_id_;
+      return true;
+    }
+  }
+  // the ring is not full yet, or its frame is gone: the slot takes a frame of the buffer pool.
+  if (!find_victim_page(frame_id)) {
+    return false;
+  }
+  slot.owner_ = this;
+  slot.frame_id_ = *frame_id;
+  slot.page_id_ = INVALID_PAGE_ID;
+  return true;
+}
+
+void BufferPoolManager::remember_page(BufferAccessStrategy *strategy, uint32_t tag, page_id_t page_id) {
+  if (strategy != nullptr) {
+    strategy->ring_[strategy->current_].tag_ = tag;
+    strategy->ring_[strategy->current_].page_id_ = page_id;
+  }
 }
 
+bool BufferPoolManager::FlushPage(page_id_t page_id) { return flush_page(0, page_id); }
+
 // flush the correspondence page into disk, return the operation state.
 // This function only does a refreshing mechanism in disk. Do not change the memory contents actually
-bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  std::scoped_lock lock{latch_};
+bool BufferPoolManager::flush_page(uint32_t tag, page_id_t page_id) {
+  std::scoped_lock lock{write_back_latch_, latch_};
   if (page_id == INVALID_PAGE_ID) {
     return false;
   }
-  auto search = page_table_.find(page_id);  // search is the pointer(iterator) to the mapping tuple.
-  if (search != page_table_.end()) {
+  frame_id_t frame_id = -1;
+  if (page_table_.Find(MakePageKey(tag, page_id), &frame_id)) {
     // found the corresponding frame page in memory.
-    frame_id_t frame_id = search->second;
     Page *page = &(pages_[frame_id]);
-    disk_manager_->WritePage(page->page_id_, page->data_);  // here the page_id_ labels the disk page_id
-    page->is_dirty_ = false;  // When we've flush the page into the disk, we need to set dirty label to be false.
+    if (page->IsMapped()) {
+      // the db file is read only.
+      return true;
+    }
+    if (page->IsDirty()) {
+      dirty_write_backs_.fetch_add(1, std::memory_order_relaxed);
+    }
+    get_disk_manager(tag)->WritePage(page->page_id_, page->data_);  // here the page_id_ labels the disk page_id
+    mark_clean(page);  // When we've flush the page into the disk, we need to set dirty label to be false.
   } else {
     // the required physical page does have corresponding frame page in the buffer memory.
     return false;
@@ -208,34 +415,569 @@ bool BufferPoolManager::FlushPage(page_id_t page_id) {
   return true;
 }
 
-void BufferPoolManager::FlushAllPages() {
-  std::scoped_lock lock{latch_};
+void BufferPoolManager::FlushAllPages() { flush_all_pages(0); }
+
+void BufferPoolManager::flush_all_pages(uint32_t tag) {
+  std::scoped_lock lock{write_back_latch_, latch_};
+  DiskManager *disk_manager = get_disk_manager(tag);
+  if (disk_manager == nullptr) {
+    return;
+  }
+  // only the dirty pages are written, in one batch sorted by their place on disk. latch_ keeps the pages in their
+  // frames until they are all written.
+  std::vector<DiskManager::PageWrite> writes;
   for (size_t i = 0; i < pool_size_; i++) {
     Page *page = &(pages_[i]);
-    if (page->page_id_ != INVALID_PAGE_ID && page->IsDirty()) {
-      disk_manager_->WritePage(page->page_id_, page->data_);
-      page->is_dirty_ = false;
+    if (page->page_id_ != INVALID_PAGE_ID && frame_tags_[i] == tag && page->IsDirty()) {
+      // cleared before the write, a change made during the write marks the page dirty again.
+      mark_clean(page);
+      writes.push_back({page->page_id_, page->data_});
+    }
+  }
+  disk_manager->WritePages(&writes);
+  dirty_write_backs_.fetch_add(writes.size(), std::memory_order_relaxed);
+  // a checkpoint: the allocations cached by the disk manager are written with the pages, then all are synced once.
+  // A checkpoint with nothing written since the last one does not sync.
+  disk_manager->FlushMetaData();
+  disk_manager->Sync();
+}
+
+void BufferPoolManager::mark_dirty(Page *page) {
+  if (!page->is_dirty_.exchange(true)) {
+    if (dirty_pages_.fetch_add(1) + 1 == flusher_high_watermark_.load(std::memory_order_relaxed)) {
+      // too many dirty pages, do not wait for the next round of the flusher.
+      flusher_cv_.notify_one();
+    }
+  }
+}
+
+void BufferPoolManager::mark_clean(Page *page) {
+  if (page->is_dirty_.exchange(false)) {
+    dirty_pages_--;
+  }
+}
+
+void BufferPoolManager::StartBackgroundFlusher(size_t low_watermark, size_t high_watermark, size_t scan_depth,
+                                               std::chrono::milliseconds interval) {
+  StopBackgroundFlusher();
+  std::scoped_lock lock{flusher_latch_};
+  flusher_low_watermark_ = low_watermark;
+  flusher_high_watermark_ = high_watermark;
+  flusher_scan_depth_ = scan_depth;
+  flusher_interval_ = interval;
+  flusher_running_ = true;
+  flusher_thread_ = std::thread(&BufferPoolManager::flusher_loop, this);
+}
+
+void BufferPoolManager::StopBackgroundFlusher() {
+  {
+    std::scoped_lock lock{flusher_latch_};
+    if (!flusher_running_) {
+      return;
+    }
+    flusher_running_ = false;
+    flusher_high_watermark_ = SIZE_MAX;
+  }
+  flusher_cv_.notify_one();
+  flusher_thread_.join();
+}
+
+void BufferPoolManager::flusher_loop() {
+  std::vector<frame_id_t> candidates;
+  std::vector<char> buffers(flusher_scan_depth_ * PAGE_SIZE);
+  std::unique_lock lock{flusher_latch_};
+  while (flusher_running_) {
+    flusher_cv_.wait_for(lock, flusher_interval_);
+    if (!flusher_running_) {
+      break;
+    }
+    lock.unlock();
+    // write back the dirty pages which are going to be victimized first, until the low watermark is reached or the
+    // eviction end of the replacer is clean.
+    while (dirty_pages_.load() > flusher_low_watermark_) {
+      candidates.clear();
+      replacer_->PeekVictims(&candidates, flusher_scan_depth_);
+      if (write_back_frames(candidates, buffers.data()) == 0) {
+        break;
+      }
+    }
+    lock.lock();
+  }
+}
+
+size_t BufferPoolManager::write_back_frames(const std::vector<frame_id_t> &frame_ids, char *buffers) {
+  struct WriteBack {
+    uint32_t tag_;
+    page_id_t page_id_;
+    std::future<bool> done_;
+  };
+  std::vector<WriteBack> writes;
+  size_t written = 0;
+  // wait for the writes in flight and unpin their pages.
+  auto complete = [&]() {
+    for (auto &write : writes) {
+      write.done_.wait();
+      dirty_write_backs_.fetch_add(1, std::memory_order_relaxed);
+      unpin_page(write.tag_, write.page_id_, false);
+    }
+    written += writes.size();
+    writes.clear();
+  };
+  std::shared_lock registry{registry_latch_};
+  std::scoped_lock lock{write_back_latch_};
+  // the pages stay pinned while they are written, at most half of the pool at a time so that the users still find
+  // victims.
+  size_t max_in_flight = std::max<size_t>(1, pool_size_ / 2);
+  for (auto frame_id : frame_ids) {
+    if (writes.size() >= max_in_flight) {
+      complete();
+    }
+    if (dirty_pages_.load() <= flusher_low_watermark_) {
+      break;
+    }
+    // the candidate may have been dropped by a Resize since it was collected.
+    if (static_cast<size_t>(frame_id) >= pool_size_) {
+      continue;
+    }
+    Page *page = &(pages_[frame_id]);
+    if (!page->IsDirty()) {
+      continue;
+    }
+    // pin the page like the hit path does: pin_count_ 0 -> 1 fails if the page is in use, or the frame is free or
+    // being replaced. While the page is pinned, the frame can not be replaced and the page id stays the same.
+    int unpinned = 0;
+    if (!page->pin_count_.compare_exchange_strong(unpinned, 1)) {
+      continue;
+    }
+    page_id_t page_id = page->page_id_;
+    uint32_t tag = frame_tags_[frame_id];
+    // clear the dirty flag before taking the copy, a change made after the copy marks the page dirty again.
+    mark_clean(page);
+    char *buffer = buffers + writes.size() * PAGE_SIZE;
+    memcpy(buffer, page->data_, PAGE_SIZE);
+    writes.push_back({tag, page_id, get_disk_manager(tag)->WritePageAsync(page_id, buffer)});
+  }
+  complete();
+  return written;
+}
+
+void BufferPoolManager::PrefetchPages(page_id_t page_id, size_t depth, NextPageIdFunc next_of) {
+  prefetch_pages(0, page_id, depth, next_of);
+}
+
+void BufferPoolManager::prefetch_pages(uint32_t tag, page_id_t page_id, size_t depth, NextPageIdFunc next_of) {
+  if (page_id == INVALID_PAGE_ID || depth == 0) {
+    return;
+  }
+  {
+    std::scoped_lock lock{prefetch_latch_};
+    if (prefetch_stopped_ || prefetch_queue_.size() >= MAX_PREFETCH_REQUESTS) {
+      return;
+    }
+    prefetch_queue_.push_back({tag, page_id, depth, next_of});
+    if (!prefetch_thread_.joinable()) {
+      prefetch_thread_ = std::thread(&BufferPoolManager::prefetcher_loop, this);
+    }
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::WaitForPrefetches() {
+  std::unique_lock lock{prefetch_latch_};
+  prefetch_idle_cv_.wait(lock, [this]() { return prefetch_stopped_ || (prefetch_queue_.empty() && !prefetch_busy_); });
+}
+
+void BufferPoolManager::stop_prefetcher() {
+  {
+    std::scoped_lock lock{prefetch_latch_};
+    prefetch_stopped_ = true;
+    prefetch_queue_.clear();
+  }
+  prefetch_cv_.notify_one();
+  prefetch_idle_cv_.notify_all();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+  if (warm_up_thread_.joinable()) {
+    warm_up_thread_.join();
+  }
+}
+
+void BufferPoolManager::prefetcher_loop() {
+  std::unique_lock lock{prefetch_latch_};
+  while (true) {
+    prefetch_cv_.wait(lock, [this]() { return prefetch_stopped_ || !prefetch_queue_.empty(); });
+    if (prefetch_stopped_) {
+      break;
+    }
+    PrefetchRequest request = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    prefetch_busy_ = true;
+    lock.unlock();
+    page_id_t page_id = request.page_id_;
+    for (size_t i = 0; i < request.depth_ && page_id != INVALID_PAGE_ID; i++) {
+      page_id = prefetch_page(request.tag_, page_id, request.next_of_);
+    }
+    lock.lock();
+    prefetch_busy_ = false;
+    if (prefetch_queue_.empty()) {
+      prefetch_idle_cv_.notify_all();
+    }
+  }
+}
+
+page_id_t BufferPoolManager::prefetch_page(uint32_t tag, page_id_t page_id, NextPageIdFunc next_of) {
+  // resident: the frame can not be replaced while the shared latch of the page table stripe is held. The page is not
+  // pinned, the read-ahead is not an access of the page.
+  // A frame which is being loaded (FRAME_NOT_RESIDENT) ends the chain, its data is not there yet.
+  PageKey key = MakePageKey(tag, page_id);
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  if (page_table_.Find(key, [&](frame_id_t frame_id) {
+        if (pages_[frame_id].pin_count_.load() >= 0) {
+          next_page_id = next_of(pages_[frame_id].data_);
+        }
+      })) {
+    return next_page_id;
+  }
+  // the disk manager stays registered while the page is read.
+  std::shared_lock registry{registry_latch_};
+  DiskManager *disk_manager = get_disk_manager(tag);
+  if (disk_manager == nullptr) {
+    return INVALID_PAGE_ID;
+  }
+  uint64_t epoch;
+  {
+    std::scoped_lock lock{latch_};
+    epoch = write_back_epoch_;
+  }
+  // read outside latch_, the page misses of the other threads do not wait for the read-ahead.
+  char buffer[PAGE_SIZE];
+  disk_manager->ReadPage(page_id, buffer);
+  next_page_id = next_of(buffer);
+  install_page(tag, page_id, buffer, epoch);
+  return next_page_id;
+}
+
+bool BufferPoolManager::install_page(uint32_t tag, page_id_t page_id, const char *buffer, uint64_t epoch) {
+  std::scoped_lock lock{latch_};
+  if (epoch != write_back_epoch_) {
+    return false;
+  }
+  frame_id_t frame_id = -1;
+  // loaded by a page miss in the meantime
+  if (page_table_.Find(MakePageKey(tag, page_id), &frame_id) || !find_victim_page(&frame_id)) {
+    return true;
+  }
+  Page *page = &(pages_[frame_id]);
+  update_page(page, tag, page_id, frame_id);
+  const char *mapped = get_disk_manager(tag)->GetMappedPage(page_id);
+  if (mapped != nullptr) {
+    page->data_ = const_cast<char *>(mapped);
+  } else {
+    memcpy(page->data_, buffer, PAGE_SIZE);
+  }
+  page->referenced_ = false;
+  page->pin_count_ = 0;
+  // unpinned, the page can be replaced if the scan does not come
+  replacer_->Unpin(frame_id);
+  return true;
+}
+
+void BufferPoolManager::get_resident_pages(uint32_t tag, std::vector<page_id_t> *page_ids) {
+  std::scoped_lock lock{latch_};
+  std::vector<frame_id_t> victims;
+  replacer_->PeekVictims(&victims, pool_size_);
+  std::vector<bool> evictable(pool_size_, false);
+  for (auto frame_id : victims) {
+    evictable[frame_id] = true;
+  }
+  // the pages in use are the hottest, then the pages of the replacer from the last to the first victim.
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].page_id_ != INVALID_PAGE_ID && frame_tags_[i] == tag && !evictable[i]) {
+      page_ids->push_back(pages_[i].page_id_);
+    }
+  }
+  for (auto iter = victims.rbegin(); iter != victims.rend(); iter++) {
+    if (pages_[*iter].page_id_ != INVALID_PAGE_ID && frame_tags_[*iter] == tag) {
+      page_ids->push_back(pages_[*iter].page_id_);
+    }
+  }
+}
+
+bool BufferPoolManager::SaveResidentPages(const std::string &file_name) { return save_resident_pages(0, file_name); }
+
+bool BufferPoolManager::save_resident_pages(uint32_t tag, const std::string &file_name) {
+  std::vector<page_id_t> page_ids;
+  get_resident_pages(tag, &page_ids);
+  std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    LOG(WARNING) << "can not write the resident pages into " << file_name << std::endl;
+    return false;
+  }
+  // | magic | count | page id 1 | page id 2 | ... |
+  uint32_t magic = WARM_UP_FILE_MAGIC;
+  auto count = static_cast<uint32_t>(page_ids.size());
+  out.write(reinterpret_cast<const char *>(&magic), sizeof(uint32_t));
+  out.write(reinterpret_cast<const char *>(&count), sizeof(uint32_t));
+  out.write(reinterpret_cast<const char *>(page_ids.data()), count * sizeof(page_id_t));
+  return out.good();
+}
+
+size_t BufferPoolManager::LoadResidentPages(const std::string &file_name, bool background) {
+  return load_resident_pages(0, file_name, background);
+}
+
+size_t BufferPoolManager::load_resident_pages(uint32_t tag, const std::string &file_name, bool background) {
+  std::ifstream in(file_name, std::ios::binary);
+  if (!in.is_open()) {
+    return 0;
+  }
+  uint32_t magic = 0;
+  uint32_t count = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(uint32_t));
+  in.read(reinterpret_cast<char *>(&count), sizeof(uint32_t));
+  std::vector<page_id_t> page_ids;
+  if (in.good() && magic == WARM_UP_FILE_MAGIC) {
+    page_ids.resize(std::min<size_t>(count, GetPoolSize()));
+    in.read(reinterpret_cast<char *>(page_ids.data()), page_ids.size() * sizeof(page_id_t));
+    if (!in.good()) {
+      page_ids.clear();
+    }
+  }
+  in.close();
+  // the list is out of date as soon as the pages are changed, a new one is written at the next clean shutdown.
+  remove(file_name.c_str());
+  size_t num_pages = page_ids.size();
+  if (num_pages == 0) {
+    return 0;
+  }
+  if (background) {
+    if (warm_up_thread_.joinable()) {
+      warm_up_thread_.join();
+    }
+    warm_up_thread_ = std::thread(&BufferPoolManager::warm_up, this, tag, std::move(page_ids));
+  } else {
+    warm_up(tag, std::move(page_ids));
+  }
+  return num_pages;
+}
+
+void BufferPoolManager::WaitForWarmUp() {
+  if (warm_up_thread_.joinable()) {
+    warm_up_thread_.join();
+  }
+}
+
+void BufferPoolManager::warm_up(uint32_t tag, std::vector<page_id_t> page_ids) {
+  auto no_next_page = [](const char * /*page_data*/) -> page_id_t { return INVALID_PAGE_ID; };
+  std::vector<char> warm_up_buffers(WARM_UP_BATCH_SIZE * PAGE_SIZE);
+  // batches from the coldest to the hottest, every batch is read in the order of the page ids.
+  size_t num_batches = (page_ids.size() + WARM_UP_BATCH_SIZE - 1) / WARM_UP_BATCH_SIZE;
+  for (size_t batch = num_batches; batch-- > 0;) {
+    auto begin = page_ids.begin() + batch * WARM_UP_BATCH_SIZE;
+    auto end = page_ids.begin() + std::min(page_ids.size(), (batch + 1) * WARM_UP_BATCH_SIZE);
+    std::sort(begin, end);
+    if (prefetch_stopped_) {
+      return;
+    }
+    std::vector<page_id_t> outdated;
+    {
+      std::shared_lock registry{registry_latch_};
+      DiskManager *disk_manager = get_disk_manager(tag);
+      if (disk_manager == nullptr) {
+        return;
+      }
+      uint64_t epoch;
+      {
+        std::scoped_lock lock{latch_};
+        epoch = write_back_epoch_;
+      }
+      // the pages of the batch are read together, they are in flight at the same time.
+      std::vector<page_id_t> reads;
+      std::vector<std::future<bool>> done;
+      for (auto iter = begin; iter != end; iter++) {
+        frame_id_t frame_id;
+        // resident already, or deallocated after the list was written.
+        if (page_table_.Find(MakePageKey(tag, *iter), &frame_id) || disk_manager->IsPageFree(*iter)) {
+          continue;
+        }
+        done.push_back(disk_manager->ReadPageAsync(*iter, warm_up_buffers.data() + reads.size() * PAGE_SIZE));
+        reads.push_back(*iter);
+      }
+      for (size_t i = 0; i < reads.size(); i++) {
+        if (done[i].get() && !install_page(tag, reads[i], warm_up_buffers.data() + i * PAGE_SIZE, epoch)) {
+          outdated.push_back(reads[i]);
+        }
+      }
+    }
+    // a page has been written back during the reads, the pages are read again one by one.
+    for (auto page_id : outdated) {
+      prefetch_page(tag, page_id, no_next_page);
     }
-    /**
-     * another way to implement this part:
-     * FlushPage(page->page_id_);
-     */
   }
 }
 
 // already implement this function in the disk_manager module.
 // @return value -> the disk page id of next page
-page_id_t BufferPoolManager::AllocatePage() {
-  int next_page_id = disk_manager_->AllocatePage();
+page_id_t BufferPoolManager::AllocatePage(uint32_t tag, page_id_t near_page_id) {
+  int next_page_id = get_disk_manager(tag)->AllocatePage(near_page_id);
   return next_page_id;
 }
 
-void BufferPoolManager::DeallocatePage(page_id_t page_id) { disk_manager_->DeAllocatePage(page_id); }
+void BufferPoolManager::DeallocatePage(page_id_t page_id, uint32_t tag) {
+  get_disk_manager(tag)->DeAllocatePage(page_id);
+}
+
+bool BufferPoolManager::Resize(size_t pool_size) {
+  // the flusher does not write a frame while the frames are changed.
+  std::scoped_lock lock{write_back_latch_, latch_};
+  size_t old_pool_size = pool_size_;
+  if (pool_size > pages_.GetMaxFrames()) {
+    return false;
+  }
+  if (pool_size >= old_pool_size) {
+    pages_.Grow(pool_size);
+    for (size_t i = old_pool_size; i < pool_size; i++) {
+      pages_[i].page_id_ = INVALID_PAGE_ID;
+      pages_[i].pin_count_ = Page::FRAME_NOT_RESIDENT;
+      free_list_.emplace_back(i);
+    }
+    pool_size_ = pool_size;
+    return true;
+  }
+  // claim all the frames to drop first (pin_count_ 0 -> FRAME_NOT_RESIDENT, like a victim), so that nothing is
+  // dropped if one of the pages is pinned.
+  std::vector<frame_id_t> claimed;
+  for (size_t i = pool_size; i < old_pool_size; i++) {
+    Page *page = &(pages_[i]);
+    if (page->page_id_ == INVALID_PAGE_ID) {
+      continue;  // in the free list
+    }
+    int unpinned = 0;
+    if (!page->pin_count_.compare_exchange_strong(unpinned, Page::FRAME_NOT_RESIDENT)) {
+      for (auto frame_id : claimed) {
+        pages_[frame_id].pin_count_ = 0;
+      }
+      return false;
+    }
+    claimed.push_back(static_cast<frame_id_t>(i));
+  }
+  for (auto frame_id : claimed) {
+    Page *page = &(pages_[frame_id]);
+    // erasing the page from the page table waits for the UnpinPage still working on the frame under the stripe latch.
+    update_page(page, frame_tags_[frame_id], INVALID_PAGE_ID, frame_id);
+    page->referenced_ = false;
+    replacer_->Pin(frame_id);
+  }
+  free_list_.remove_if([pool_size](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= pool_size; });
+  pool_size_ = pool_size;
+  pages_.Shrink(pool_size);
+  return true;
+}
+
+BufferPoolStats BufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  stats.pool_size_ = pool_size_;
+  stats.fetch_hits_ = fetch_hits_.load(std::memory_order_relaxed);
+  stats.fetch_misses_ = fetch_misses_.load(std::memory_order_relaxed);
+  stats.evictions_ = evictions_.load(std::memory_order_relaxed);
+  stats.dirty_write_backs_ = dirty_write_backs_.load(std::memory_order_relaxed);
+  stats.new_pages_ = new_pages_.load(std::memory_order_relaxed);
+  stats.deleted_pages_ = deleted_pages_.load(std::memory_order_relaxed);
+  stats.pin_wait_failures_ = pin_wait_failures_.load(std::memory_order_relaxed);
+  stats.dirty_pages_ = dirty_pages_.load();
+  return stats;
+}
+
+// the guards call the virtual interface, they work the same with every kind of buffer pool manager.
+BasicPageGuard BufferPoolManager::FetchPageBasic(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return BasicPageGuard(this, page_id, FetchPage(page_id, strategy));
+}
+
+ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id) {
+  BasicPageGuard guard(this, page_id, FetchPage(page_id));
+  if (guard) {
+    guard.GetPage()->RLatch();
+  }
+  return ReadPageGuard(std::move(guard));
+}
+
+WritePageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id) {
+  if (IsReadOnly()) {
+    return WritePageGuard(BasicPageGuard(this, page_id, nullptr));
+  }
+  BasicPageGuard guard(this, page_id, FetchPage(page_id));
+  if (guard) {
+    guard.GetPage()->WLatch();
+  }
+  return WritePageGuard(std::move(guard));
+}
+
+BasicPageGuard BufferPoolManager::NewPageGuarded(page_id_t &page_id, BufferAccessStrategy *strategy) {
+  Page *page = NewPage(page_id, strategy);
+  return BasicPageGuard(this, page_id, page);
+}
+
+BasicPageGuard BufferPoolManager::NewPageGuardedNear(page_id_t &page_id, page_id_t near_page_id) {
+  Page *page = NewPageNear(page_id, near_page_id);
+  return BasicPageGuard(this, page_id, page);
+}
+
+bool BufferPoolManager::IsPageFree(page_id_t page_id) { return is_page_free(0, page_id); }
+
+bool BufferPoolManager::is_page_free(uint32_t tag, page_id_t page_id) {
+  std::shared_lock registry{registry_latch_};
+  DiskManager *disk_manager = get_disk_manager(tag);
+  return disk_manager == nullptr || disk_manager->IsPageFree(page_id);
+}
+
+DiskManager *BufferPoolManager::get_disk_manager(uint32_t tag) {
+  auto search = disk_managers_.find(tag);
+  return search == disk_managers_.end() ? nullptr : search->second;
+}
+
+uint32_t BufferPoolManager::register_disk_manager(DiskManager *disk_manager) {
+  std::unique_lock registry{registry_latch_};
+  std::scoped_lock lock{latch_};
+  uint32_t tag = next_tag_++;
+  disk_managers_[tag] = disk_manager;
+  return tag;
+}
+
+void BufferPoolManager::unregister_disk_manager(uint32_t tag) {
+  {
+    // the pending read-ahead of the database is dropped
+    std::scoped_lock lock{prefetch_latch_};
+    for (auto iter = prefetch_queue_.begin(); iter != prefetch_queue_.end();) {
+      iter = iter->tag_ == tag ? prefetch_queue_.erase(iter) : iter + 1;
+    }
+  }
+  // wait for the background threads reading or writing a page of the database.
+  std::unique_lock registry{registry_latch_};
+  std::scoped_lock lock{write_back_latch_, latch_};
+  DiskManager *disk_manager = get_disk_manager(tag);
+  if (disk_manager == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < pool_size_; i++) {
+    Page *page = &(pages_[i]);
+    if (page->page_id_ == INVALID_PAGE_ID || frame_tags_[i] != tag) {
+      continue;
+    }
+    // the database is closed, nobody uses its pages any more. The frame is taken even if a page was not unpinned.
+    page->pin_count_ = Page::FRAME_NOT_RESIDENT;
+    update_page(page, tag, INVALID_PAGE_ID, static_cast<frame_id_t>(i));
+    page->referenced_ = false;
+    replacer_->Pin(static_cast<frame_id_t>(i));
+    free_list_.push_back(static_cast<frame_id_t>(i));
+  }
+  disk_managers_.erase(tag);
+}
 
-bool BufferPoolManager::IsPageFree(page_id_t page_id) { return disk_manager_->IsPageFree(page_id); }
+bool BufferPoolManager::CheckAllUnpinned() { return check_all_unpinned(0); }
 
 // Only used for debug
-bool BufferPoolManager::CheckAllUnpinned() {
+bool BufferPoolManager::check_all_unpinned(uint32_t tag) {
   bool res = true;
   //for (size_t i = 0; i < 100; i++) {
   //
@@ -245,7 +987,7 @@ bool BufferPoolManager::CheckAllUnpinned() {
   //  
   //}
   for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].pin_count_ != 0) {
+    if (pages_[i].pin_count_ > 0 && frame_tags_[i] == tag) {
       res = false;
       LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
       cout << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
@@ -0,0 +1,83 @@
+#include "buffer/clock_replacer.h"
+
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : max_size(num_pages),
+      ref_bits_(new std::atomic<bool>[num_pages]),
+      evictable_(new std::atomic<bool>[num_pages]) {
+  for (size_t i = 0; i < max_size; i++) {
+    ref_bits_[i] = false;
+    evictable_[i] = false;
+  }
+}
+
+ClockReplacer::~ClockReplacer() = default;
+
+// sweep the clock hand until an evictable frame without reference bit is found.
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  if (max_size == 0) {
+    return false;
+  }
+  // two sweeps are enough to clear all the reference bits and come back to a frame, unless the frames are unpinned
+  // concurrently. Give up after a few sweeps instead of spinning.
+  for (size_t step = 0; step < 4 * max_size && size_.load() > 0; step++) {
+    size_t frame = clock_hand_.fetch_add(1) % max_size;
+    if (!evictable_[frame].load()) {
+      continue;
+    }
+    if (ref_bits_[frame].exchange(false)) {
+      // second chance
+      continue;
+    }
+    bool expected = true;
+    // claim the frame, another victim search or a pin may have taken it in the meantime.
+    if (evictable_[frame].compare_exchange_strong(expected, false)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(frame);
+      return true;
+    }
+  }
+  return false;
+}
+
+// take the frame out of the replacer.
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if (static_cast<size_t>(frame_id) >= max_size) {
+    return;
+  }
+  bool expected = true;
+  if (evictable_[frame_id].compare_exchange_strong(expected, false)) {
+    size_--;
+  }
+}
+
+// put the frame into the replacer, with the reference bit set. Like the other replacers, unpinning a frame which is
+// already evictable changes nothing.
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  if (static_cast<size_t>(frame_id) >= max_size || evictable_[frame_id].load()) {
+    return;
+  }
+  ref_bits_[frame_id] = true;
+  bool expected = false;
+  if (evictable_[frame_id].compare_exchange_strong(expected, true)) {
+    size_++;
+  }
+}
+
+size_t ClockReplacer::Size() {
+  int64_t size = size_.load();
+  return size > 0 ? static_cast<size_t>(size) : 0;
+}
+
+// the frames ahead of the clock hand: the ones without reference bit are victimized in the first sweep, the others in
+// the second sweep.
+void ClockReplacer::PeekVictims(std::vector<frame_id_t> *frames, size_t max_num) {
+  size_t hand = clock_hand_.load();
+  for (bool referenced : {false, true}) {
+    for (size_t step = 0; step < max_size && frames->size() < max_num; step++) {
+      size_t frame = (hand + step) % max_size;
+      if (evictable_[frame].load() && ref_bits_[frame].load() == referenced) {
+        frames->push_back(static_cast<frame_id_t>(frame));
+      }
+    }
+  }
+}
@@ -0,0 +1,70 @@
+#include "buffer/lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : k_(k == 0 ? 1 : k), history_(num_pages), evictable_(num_pages, false), max_size(num_pages) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+LRUKReplacer::EvictKey LRUKReplacer::GetEvictKey(frame_id_t frame_id) const {
+  const std::deque<size_t> &history = history_[frame_id];
+  if (history.size() < k_) {
+    // less than k accesses -> +inf backward k-distance, the oldest access is evicted first (plain LRU among them).
+    return EvictKey(0, history.front(), frame_id);
+  }
+  // the front is the k-th most recent access, the smaller it is, the larger the backward k-distance is.
+  return EvictKey(1, history.front(), frame_id);
+}
+
+// find the frame with the largest backward k-distance and clear it out.
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock{mutx_};
+  if (evictable_set_.empty()) {
+    return false;
+  }
+  auto victim = evictable_set_.begin();
+  *frame_id = std::get<2>(*victim);
+  evictable_set_.erase(victim);
+  evictable_[*frame_id] = false;
+  // the frame will hold another page, so the access history of the old page is dropped.
+  history_[*frame_id].clear();
+  return true;
+}
+
+// the frame is in use, it can not be seen by the victim selection. The access history is kept.
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock{mutx_};
+  if (static_cast<size_t>(frame_id) >= max_size || !evictable_[frame_id]) {
+    return;
+  }
+  evictable_set_.erase(GetEvictKey(frame_id));
+  evictable_[frame_id] = false;
+}
+
+// record an access of the frame and put it back into the evictable set.
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock{mutx_};
+  // out of range, or already evictable (avoid the repeated addition of the element)
+  if (static_cast<size_t>(frame_id) >= max_size || evictable_[frame_id]) {
+    return;
+  }
+  std::deque<size_t> &history = history_[frame_id];
+  history.push_back(current_timestamp_++);
+  if (history.size() > k_) {
+    history.pop_front();
+  }
+  evictable_set_.insert(GetEvictKey(frame_id));
+  evictable_[frame_id] = true;
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock lock{mutx_};
+  return evictable_set_.size();
+}
+
+// the victims are taken from the beginning of the evictable set.
+void LRUKReplacer::PeekVictims(std::vector<frame_id_t> *frames, size_t max_num) {
+  std::scoped_lock lock{mutx_};
+  for (auto iter = evictable_set_.begin(); iter != evictable_set_.end() && frames->size() < max_num; iter++) {
+    frames->push_back(std::get<2>(*iter));
+  }
+}
@@ -55,3 +55,11 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
 
 size_t LRUReplacer::Size() { return LRU_list.size(); }  
 // return the current size of the buffer frame.
+
+// the victims are taken from the tail of the list.
+void LRUReplacer::PeekVictims(std::vector<frame_id_t> *frames, size_t max_num) {
+  std::scoped_lock lock{mutx_};
+  for (auto iter = LRU_list.rbegin(); iter != LRU_list.rend() && frames->size() < max_num; iter++) {
+    frames->push_back(*iter);
+  }
+}
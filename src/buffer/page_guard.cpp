@@ -0,0 +1,10 @@
+#include "buffer/page_guard.h"
+
+#include "buffer/buffer_pool_manager.h"
+
+void BasicPageGuard::Drop() {
+  if (page_ != nullptr) {
+    bpm_->UnpinPage(page_id_, is_dirty_);
+    Clear();
+  }
+}
@@ -0,0 +1,159 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, ReplacerType replacer_type,
+                                                     size_t max_pool_size)
+    : BufferPoolManager(disk_manager), num_instances_(num_instances == 0 ? 1 : num_instances) {
+  for (size_t i = 0; i < num_instances_; i++) {
+    instances_.push_back(new BufferPoolManager(pool_size, disk_manager, replacer_type, max_pool_size));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  stop_prefetcher();
+  // every instance flushes its own pages in its dtor.
+  for (auto instance : instances_) {
+    delete instance;
+  }
+}
+
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id) { return GetInstance(page_id)->FetchPage(page_id); }
+
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return GetInstance(page_id)->FetchPage(page_id, strategy);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetInstance(page_id)->FlushPage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPages() {
+  for (auto instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id) { return NewPage(page_id, nullptr); }
+
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id, BufferAccessStrategy *strategy) {
+  return new_page_near(page_id, INVALID_PAGE_ID, strategy);
+}
+
+Page *ParallelBufferPoolManager::NewPageNear(page_id_t &page_id, page_id_t near_page_id) {
+  return new_page_near(page_id, near_page_id, nullptr);
+}
+
+Page *ParallelBufferPoolManager::new_page_near(page_id_t &page_id, page_id_t near_page_id,
+                                               BufferAccessStrategy *strategy) {
+  // the latch only serializes the allocation, the instance takes its own latch to find a frame.
+  std::scoped_lock lock{latch_};
+  page_id_t new_page_id = AllocatePage(0, near_page_id);
+  if (new_page_id == INVALID_PAGE_ID) {
+    // the db file is read only, or full.
+    return nullptr;
+  }
+  Page *page = GetInstance(new_page_id)->NewPageWithId(new_page_id, strategy);
+  if (page == nullptr) {
+    // all the frames of the responsible instance are pinned, give the page id back.
+    DeallocatePage(new_page_id);
+    return nullptr;
+  }
+  page_id = new_page_id;
+  return page;
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) { return GetInstance(page_id)->DeletePage(page_id); }
+
+bool ParallelBufferPoolManager::IsPageFree(page_id_t page_id) { return disk_manager_->IsPageFree(page_id); }
+
+bool ParallelBufferPoolManager::CheckAllUnpinned() {
+  bool res = true;
+  for (auto instance : instances_) {
+    res = instance->CheckAllUnpinned() && res;
+  }
+  return res;
+}
+
+void ParallelBufferPoolManager::StartBackgroundFlusher(size_t low_watermark, size_t high_watermark, size_t scan_depth,
+                                                       std::chrono::milliseconds interval) {
+  for (auto instance : instances_) {
+    instance->StartBackgroundFlusher(low_watermark, high_watermark, scan_depth, interval);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundFlusher() {
+  for (auto instance : instances_) {
+    instance->StopBackgroundFlusher();
+  }
+}
+
+size_t ParallelBufferPoolManager::GetDirtyPageCount() {
+  size_t dirty_pages = 0;
+  for (auto instance : instances_) {
+    dirty_pages += instance->GetDirtyPageCount();
+  }
+  return dirty_pages;
+}
+
+BufferPoolStats ParallelBufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  for (auto instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+bool ParallelBufferPoolManager::Resize(size_t pool_size) {
+  bool res = true;
+  for (size_t i = 0; i < num_instances_; i++) {
+    // the first instances take the remainder.
+    size_t instance_pool_size = pool_size / num_instances_ + (i < pool_size % num_instances_ ? 1 : 0);
+    res = instances_[i]->Resize(instance_pool_size) && res;
+  }
+  return res;
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() const {
+  size_t pool_size = 0;
+  for (auto instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+page_id_t ParallelBufferPoolManager::prefetch_page(uint32_t tag, page_id_t page_id, NextPageIdFunc next_of) {
+  return GetInstance(page_id)->prefetch_page(tag, page_id, next_of);
+}
+
+void ParallelBufferPoolManager::get_resident_pages(uint32_t tag, std::vector<page_id_t> *page_ids) {
+  std::vector<std::vector<page_id_t>> instance_pages(num_instances_);
+  size_t max_pages = 0;
+  for (size_t i = 0; i < num_instances_; i++) {
+    instances_[i]->get_resident_pages(tag, &instance_pages[i]);
+    max_pages = std::max(max_pages, instance_pages[i].size());
+  }
+  for (size_t rank = 0; rank < max_pages; rank++) {
+    for (auto &pages : instance_pages) {
+      if (rank < pages.size()) {
+        page_ids->push_back(pages[rank]);
+      }
+    }
+  }
+}
+
+void ParallelBufferPoolManager::warm_up(uint32_t tag, std::vector<page_id_t> page_ids) {
+  std::vector<std::vector<page_id_t>> instance_pages(num_instances_);
+  for (auto page_id : page_ids) {
+    instance_pages[static_cast<uint32_t>(page_id) % num_instances_].push_back(page_id);
+  }
+  for (size_t i = 0; i < num_instances_ && !prefetch_stopped_; i++) {
+    instances_[i]->warm_up(tag, std::move(instance_pages[i]));
+  }
+}
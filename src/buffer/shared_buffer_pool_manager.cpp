@@ -0,0 +1,57 @@
+#include "buffer/shared_buffer_pool_manager.h"
+
+SharedBufferPoolManager::SharedBufferPoolManager(BufferPoolManager *pool, DiskManager *disk_manager)
+    : BufferPoolManager(disk_manager), pool_(pool), tag_(pool->register_disk_manager(disk_manager)) {}
+
+SharedBufferPoolManager::~SharedBufferPoolManager() { pool_->unregister_disk_manager(tag_); }
+
+Page *SharedBufferPoolManager::FetchPage(page_id_t page_id) { return pool_->fetch_page(tag_, page_id, nullptr); }
+
+Page *SharedBufferPoolManager::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return pool_->fetch_page(tag_, page_id, strategy);
+}
+
+bool SharedBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  return pool_->unpin_page(tag_, page_id, is_dirty);
+}
+
+bool SharedBufferPoolManager::FlushPage(page_id_t page_id) { return pool_->flush_page(tag_, page_id); }
+
+void SharedBufferPoolManager::FlushAllPages() { pool_->flush_all_pages(tag_); }
+
+Page *SharedBufferPoolManager::NewPage(page_id_t &page_id) { return pool_->new_page(tag_, page_id, nullptr); }
+
+Page *SharedBufferPoolManager::NewPage(page_id_t &page_id, BufferAccessStrategy *strategy) {
+  return pool_->new_page(tag_, page_id, strategy);
+}
+
+Page *SharedBufferPoolManager::NewPageNear(page_id_t &page_id, page_id_t near_page_id) {
+  return pool_->new_page(tag_, page_id, nullptr, near_page_id);
+}
+
+bool SharedBufferPoolManager::DeletePage(page_id_t page_id) { return pool_->delete_page(tag_, page_id); }
+
+bool SharedBufferPoolManager::IsPageFree(page_id_t page_id) { return pool_->is_page_free(tag_, page_id); }
+
+bool SharedBufferPoolManager::CheckAllUnpinned() { return pool_->check_all_unpinned(tag_); }
+
+void SharedBufferPoolManager::StartBackgroundFlusher(size_t low_watermark, size_t high_watermark, size_t scan_depth,
+                                                     std::chrono::milliseconds interval) {
+  pool_->StartBackgroundFlusher(low_watermark, high_watermark, scan_depth, interval);
+}
+
+void SharedBufferPoolManager::StopBackgroundFlusher() { pool_->StopBackgroundFlusher(); }
+
+size_t SharedBufferPoolManager::GetDirtyPageCount() { return pool_->GetDirtyPageCount(); }
+
+void SharedBufferPoolManager::PrefetchPages(page_id_t page_id, size_t depth, NextPageIdFunc next_of) {
+  pool_->prefetch_pages(tag_, page_id, depth, next_of);
+}
+
+bool SharedBufferPoolManager::SaveResidentPages(const std::string &file_name) {
+  return pool_->save_resident_pages(tag_, file_name);
+}
+
+size_t SharedBufferPoolManager::LoadResidentPages(const std::string &file_name, bool background) {
+  return pool_->load_resident_pages(tag_, file_name, background);
+}
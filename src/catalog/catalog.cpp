@@ -105,7 +105,8 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
       buffer_pool_manager_->UnpinPage(i.second, false);
       if (table_meta != nullptr) { // here the heap does not need to be created for the first time, it has been created when create_table last time, this time just read the information out
         auto *table_heap = TableHeap::Create(buffer_pool_manager_, table_meta->GetFirstPageId(),
-                                             table_meta->GetSchema(), nullptr, nullptr, table_info->GetMemHeap());
+                                             table_meta->GetSchema(), nullptr, nullptr, table_info->GetMemHeap(),
+                                             table_meta->GetFreeSpaceMapPageId());
         table_info->Init(table_meta, table_heap);
         cur_name = table_info->GetTableName();
         this->table_names_.emplace(cur_name, i.first);
@@ -141,7 +142,8 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
           if (table_meta != nullptr) {
             auto *table_heap = TableHeap::Create(buffer_pool_manager_, table_meta->GetFirstPageId(),
                                                  table_meta->GetSchema(),
-                                                 nullptr, nullptr, table_info->GetMemHeap());
+                                                 nullptr, nullptr, table_info->GetMemHeap(),
+                                                 table_meta->GetFreeSpaceMapPageId());
             table_info->Init(table_meta, table_heap);
             cor_table_name = table_info->GetTableName();
           }
@@ -173,6 +175,11 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
 }
 
 CatalogManager::~CatalogManager() {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    // nothing can have changed, and the meta page can not be written.
+    delete heap_;
+    return;
+  }
   Page* page = this->buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
   this->catalog_meta_->SerializeTo(page->GetData());
   this->buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, true);
@@ -181,6 +188,9 @@ CatalogManager::~CatalogManager() {
 
 dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schema, Transaction *txn,
                                     TableInfo *&table_info) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return DB_FAILED;
+  }
   auto iter = this->table_names_.find(table_name);
   if (iter != table_names_.end()) {
     // this table name has been occupied
@@ -202,7 +212,8 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   auto table_heap =
       TableHeap::Create(buffer_pool_manager_, schema, nullptr, nullptr, nullptr, table_info_tmp->GetMemHeap());
   TableMetadata *table_meta =
-      TableMetadata::Create(next_table_id_tmp, table_name, table_heap->GetFirstPageId(), schema, heap_);
+      TableMetadata::Create(next_table_id_tmp, table_name, table_heap->GetFirstPageId(), schema, heap_,
+                            table_heap->GetFreeSpaceMapPageId());
   // 3. table_meta SerializeTo TableMetaPage
   table_meta->SerializeTo(page->GetData());
 
@@ -256,6 +267,9 @@ dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const {
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<std::string> &index_keys, Transaction *txn,
                                     IndexInfo *&index_info) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return DB_FAILED;
+  }
   auto iter_table = table_names_.find(table_name);
   // this iterator will be needed when emplace new index record into the table
   if (iter_table == table_names_.end()) {
@@ -400,6 +414,9 @@ dberr_t CatalogManager::GetTableIndexes(const std::string &table_name, std::vect
 }
 
 dberr_t CatalogManager::DropTable(const string &table_name) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return DB_FAILED;
+  }
   // 1. first need to check whether this table is created before.
   auto iter_table_names = this->table_names_.find(table_name);
   if (iter_table_names == this->table_names_.end()) {
@@ -457,6 +474,9 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
 // note that the caller must need to judge whether there is no more indexes left on some tables
 // if no more, do not forget to clear the nested mapping away.
 dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_name, bool refresh) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return DB_FAILED;
+  }
   // Note that we should call the b_plus_tree's destroy, the destroy function will update the index_roots_page (check again)
   // call buffer_pool_manager_'s deletepage to delete corresponding pages.
   auto iter_table_names = this->table_names_.find(table_name);
@@ -5,7 +5,7 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
   uint32_t ofs = 0; // record the total offset returned
 
   // 1. first write in the magic number for recognization of TableMetaData
-  MACH_WRITE_UINT32(buf + ofs, TABLE_METADATA_MAGIC_NUM);
+  MACH_WRITE_UINT32(buf + ofs, TABLE_METADATA_FSM_MAGIC_NUM);
   ofs += sizeof(uint32_t);
 
   // 2. then write in the table_id_
@@ -24,6 +24,10 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
   MACH_WRITE_INT32(buf + ofs, root_page_id_);
   ofs += sizeof(root_page_id_);
 
+  // 5.1 then write in the free_space_map_page_id_
+  MACH_WRITE_INT32(buf + ofs, free_space_map_page_id_);
+  ofs += sizeof(free_space_map_page_id_);
+
   // 6. then write in the schema pointer
   this->schema_->SerializeTo(buf + ofs);
   ofs += this->schema_->GetSerializedSize();
@@ -36,8 +40,8 @@ uint32_t TableMetadata::GetSerializedSize() const {
   if (table_name_.length() == 0) {
     return 0;
   }
-  return this->schema_->GetSerializedSize() + sizeof(root_page_id_) + table_name_.size() + sizeof(table_id_) +
-         sizeof(uint32_t) * 2;
+  return this->schema_->GetSerializedSize() + sizeof(root_page_id_) + sizeof(free_space_map_page_id_) +
+         table_name_.size() + sizeof(table_id_) + sizeof(uint32_t) * 2;
 }
 
 /**
@@ -54,7 +58,8 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
   char *orig_buf = buf;
   // 1. read and check the magic number
   uint32_t magic_num = MACH_READ_UINT32(buf);
-  ASSERT(magic_num == TABLE_METADATA_MAGIC_NUM, "TABLE_META_DATA_MAGIC_NUM does not match");
+  ASSERT(magic_num == TABLE_METADATA_MAGIC_NUM || magic_num == TABLE_METADATA_FSM_MAGIC_NUM,
+         "TABLE_META_DATA_MAGIC_NUM does not match");
   buf += sizeof(uint32_t);
 
   // 2. read the table_id_
@@ -76,11 +81,18 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
   page_id_t root_id_tmp = MACH_READ_INT32(buf);
   buf += sizeof(page_id_t);
 
+  // 5.1 read the free_space_map_page_id_, a table written before the free space map has none
+  page_id_t free_space_map_id_tmp = INVALID_PAGE_ID;
+  if (magic_num == TABLE_METADATA_FSM_MAGIC_NUM) {
+    free_space_map_id_tmp = MACH_READ_INT32(buf);
+    buf += sizeof(page_id_t);
+  }
+
   // 6. read the schema pointer out
   Schema *schema_tmp = nullptr;
   buf += Schema::DeserializeFrom(buf, schema_tmp, heap);
    
-  table_meta = Create(table_id_tmp, name_tmp, root_id_tmp, schema_tmp, heap);
+  table_meta = Create(table_id_tmp, name_tmp, root_id_tmp, schema_tmp, heap, free_space_map_id_tmp);
 
   return buf - orig_buf;
 }
@@ -91,11 +103,14 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
  * @param heap Memory heap passed by TableInfo
  */
 TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name,
-                                     page_id_t root_page_id, TableSchema *schema, MemHeap *heap) {
+                                     page_id_t root_page_id, TableSchema *schema, MemHeap *heap,
+                                     page_id_t free_space_map_page_id) {
   // allocate space for table metadata
   void *buf = heap->Allocate(sizeof(TableMetadata));
-  return new(buf)TableMetadata(table_id, table_name, root_page_id, schema);
+  return new(buf)TableMetadata(table_id, table_name, root_page_id, schema, free_space_map_page_id);
 }
 
-TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema)
-        : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema) {}
+TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                             page_id_t free_space_map_page_id)
+        : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id),
+          free_space_map_page_id_(free_space_map_page_id), schema_(schema) {}
@@ -5,8 +5,10 @@ int yyparse(void);
 #include "parser/parser.h"
 }
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
+#include <numeric>
 #include <ctime>
 #include <cstdlib>
 #include "executor/execute_engine.h"
@@ -97,50 +99,50 @@ void GetSatisfiedRow(pSyntaxNode Curr_Node, CatalogManager *Curr_Ctr, string Tab
       ExistIndexInfo->GetIndex()->ScanKey(row, Result, nullptr);
 
     } else {
-      // Using Table Heap
+      // Using Table Heap, only the compared column of each tuple is read
       for (auto iter = table_info->GetTableHeap()->Begin(nullptr); iter != table_info->GetTableHeap()->End(); ++iter) {
-        if (iter->GetField(ColumnIndex)->CompareEquals(fields.front()) == CmpBool::kTrue) {
-          Result.push_back(iter->GetRowId());
+        if (iter.View().GetField(ColumnIndex).CompareEquals(fields.front()) == CmpBool::kTrue) {
+          Result.push_back(iter.View().GetRowId());
         }
       }
     }
   } else if (Connector == "<>") {
     // Using Table Heap
     for (auto iter = table_info->GetTableHeap()->Begin(nullptr); iter != table_info->GetTableHeap()->End(); ++iter) {
-      if (iter->GetField(ColumnIndex)->CompareNotEquals(fields.front()) == CmpBool::kTrue) {
-        Result.push_back(iter->GetRowId());
+      if (iter.View().GetField(ColumnIndex).CompareNotEquals(fields.front()) == CmpBool::kTrue) {
+        Result.push_back(iter.View().GetRowId());
       }
     }
 
   } else if (Connector == ">=") {
     // Using Table Heap
     for (auto iter = table_info->GetTableHeap()->Begin(nullptr); iter != table_info->GetTableHeap()->End(); ++iter) {
-      if (iter->GetField(ColumnIndex)->CompareGreaterThanEquals(fields.front()) == CmpBool::kTrue) {
-        Result.push_back(iter->GetRowId());
+      if (iter.View().GetField(ColumnIndex).CompareGreaterThanEquals(fields.front()) == CmpBool::kTrue) {
+        Result.push_back(iter.View().GetRowId());
       }
     }
 
   } else if (Connector == "<=") {
     // Using Table Heap
     for (auto iter = table_info->GetTableHeap()->Begin(nullptr); iter != table_info->GetTableHeap()->End(); ++iter) {
-      if (iter->GetField(ColumnIndex)->CompareLessThanEquals(fields.front()) == CmpBool::kTrue) {
-        Result.push_back(iter->GetRowId());
+      if (iter.View().GetField(ColumnIndex).CompareLessThanEquals(fields.front()) == CmpBool::kTrue) {
+        Result.push_back(iter.View().GetRowId());
       }
     }
 
   } else if (Connector == "<") {
     // Using Table Heap
     for (auto iter = table_info->GetTableHeap()->Begin(nullptr); iter != table_info->GetTableHeap()->End(); ++iter) {
-      if (iter->GetField(ColumnIndex)->CompareLessThan(fields.front()) == CmpBool::kTrue) {
-        Result.push_back(iter->GetRowId());
+      if (iter.View().GetField(ColumnIndex).CompareLessThan(fields.front()) == CmpBool::kTrue) {
+        Result.push_back(iter.View().GetRowId());
       }
     }
 
   } else if (Connector == ">") {
     // Using Table Heap
     for (auto iter = table_info->GetTableHeap()->Begin(nullptr); iter != table_info->GetTableHeap()->End(); ++iter) {
-      if (iter->GetField(ColumnIndex)->CompareGreaterThan(fields.front()) == CmpBool::kTrue) {
-        Result.push_back(iter->GetRowId());
+      if (iter.View().GetField(ColumnIndex).CompareGreaterThan(fields.front()) == CmpBool::kTrue) {
+        Result.push_back(iter.View().GetRowId());
       }
     }
   }
@@ -195,7 +197,47 @@ void GetSatifedRowSet(pSyntaxNode ast, string TableName, CatalogManager *Current
     GetSatisfiedRow(Curr_Node, Current_Ctr, TableName, Result);
   }
 }
-ExecuteEngine::ExecuteEngine() {
+// insert the keys of the inserted rows into every index of the table. The entries of an index are inserted in the
+// order of their keys, so that the inserts which follow one another go down the same path of the B+ tree.
+void InsertIntoIndexes(CatalogManager *Current_Ctr, const string &TableName, std::vector<Row> &Rows) {
+  std::vector<IndexInfo *> indexes;
+  if (Current_Ctr->GetTableIndexes(TableName, indexes) != DB_SUCCESS) {
+    return;
+  }
+  for (auto index_info : indexes) {
+    const std::vector<uint32_t> &key_map = index_info->GetMetaData()->GetKeyMapping();
+    std::vector<Row> keys;
+    keys.reserve(Rows.size());
+    for (auto &row : Rows) {
+      std::vector<Field> fields;
+      for (auto column_index : key_map) {
+        fields.push_back(*(row.GetField(column_index)));
+      }
+      keys.emplace_back(fields);
+      keys.back().SetRowId(row.GetRowId());
+    }
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      for (uint32_t i = 0; i < key_map.size(); i++) {
+        if (keys[a].GetField(i)->CompareLessThan(*keys[b].GetField(i)) == kTrue) {
+          return true;
+        }
+        if (keys[b].GetField(i)->CompareLessThan(*keys[a].GetField(i)) == kTrue) {
+          return false;
+        }
+      }
+      return false;
+    });
+    for (auto i : order) {
+      index_info->GetIndex()->InsertEntry(keys[i], keys[i].GetRowId(), nullptr);
+    }
+  }
+}
+
+ExecuteEngine::ExecuteEngine(size_t buffer_pool_bytes)
+    : shared_pool_(new BufferPoolManager(std::max<size_t>(buffer_pool_bytes / PAGE_SIZE, 1), nullptr, kReplacerLRU,
+                                         std::max<size_t>(buffer_pool_bytes / PAGE_SIZE, 1) * BUFFER_POOL_MAX_GROWTH)) {
   // find the file in the bin file folder, and fill the contents in the object
   // all the private value can be initialized by using the disk manager when used.
   // add the txt file implementation, format -> every line contains a database storage file's name (of course no spaces
@@ -218,17 +260,34 @@ ExecuteEngine::ExecuteEngine() {
   std::string db_file_names;
   while (db_contents >> db_file_names) {
     if (!db_file_names.empty()) {
-      DBStorageEngine *store_eng = new DBStorageEngine(db_file_names, false);
+      DBStorageEngine *store_eng = new DBStorageEngine(db_file_names, shared_pool_, false);
       this->dbs_.emplace(db_file_names, store_eng);
     }
   }
   db_contents.close();
 }
 
+bool ExecuteEngine::ResizeBufferPool(size_t buffer_pool_bytes) {
+  return shared_pool_->Resize(std::max<size_t>(buffer_pool_bytes / PAGE_SIZE, 1));
+}
+
+// the statements which change the current database
+static bool IsWriteStatement(SyntaxNodeType type) {
+  return type == kNodeCreateTable || type == kNodeDropTable || type == kNodeCreateIndex || type == kNodeDropIndex ||
+         type == kNodeInsert || type == kNodeDelete || type == kNodeUpdate;
+}
+
 dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
   if (ast == nullptr) {
     return DB_FAILED;
   }
+  if (IsWriteStatement(ast->type_)) {
+    auto db = dbs_.find(current_db_);
+    if (db != dbs_.end() && db->second->read_only_) {
+      std::cerr << "The database " << current_db_ << " is read only" << std::endl;
+      return DB_FAILED;
+    }
+  }
   switch (ast->type_) {
       // yhm
     case kNodeCreateDB:  //-ok
@@ -254,6 +313,8 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
       // yhm
     case kNodeShowIndexes:  //--ok
       return ExecuteShowIndexes(ast, context);
+    case kNodeShowStatus:
+      return ExecuteShowStatus(ast, context);
       // yhm
     case kNodeCreateIndex:  //-ok
       return ExecuteCreateIndex(ast, context);
@@ -307,7 +368,7 @@ dberr_t ExecuteEngine::ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *co
     return DB_FAILED;
   }
   // 2. if the database is not duplicated, then create a new database.
-  DBStorageEngine *store_eng = new DBStorageEngine(db_file_name, true);  // create a new database
+  DBStorageEngine *store_eng = new DBStorageEngine(db_file_name, shared_pool_, true);  // create a new database
   this->dbs_.emplace(db_file_name, store_eng);
   printf("DATABASE CREATION ");
   return DB_SUCCESS;
@@ -355,6 +416,33 @@ dberr_t ExecuteEngine::ExecuteShowDatabases(pSyntaxNode ast, ExecuteContext *con
   return DB_SUCCESS;
 }
 
+// Show Status: the counters of the buffer pool shared by the databases
+dberr_t ExecuteEngine::ExecuteShowStatus(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteShowStatus" << std::endl;
+#endif
+  BufferPoolStats stats = shared_pool_->GetStats();
+  std::vector<std::pair<std::string, size_t>> rows = {{"Buffer_pool_size", stats.pool_size_},
+                                                       {"Buffer_pool_fetch_hits", stats.fetch_hits_},
+                                                       {"Buffer_pool_fetch_misses", stats.fetch_misses_},
+                                                       {"Buffer_pool_evictions", stats.evictions_},
+                                                       {"Buffer_pool_dirty_write_backs", stats.dirty_write_backs_},
+                                                       {"Buffer_pool_new_pages", stats.new_pages_},
+                                                       {"Buffer_pool_deleted_pages", stats.deleted_pages_},
+                                                       {"Buffer_pool_pin_wait_failures", stats.pin_wait_failures_},
+                                                       {"Buffer_pool_dirty_pages", stats.dirty_pages_}};
+  std::cout << "+-------------------------------+-----------------+" << endl;
+  std::cout << "| Variable_name                 | Value           |" << endl;
+  std::cout << "+-------------------------------+-----------------+" << endl;
+  for (auto &row : rows) {
+    std::cout << "| " << left << setw(30) << row.first << "| " << left << setw(16) << row.second << '|' << endl;
+  }
+  std::cout << "| " << left << setw(30) << "Buffer_pool_hit_ratio"
+            << "| " << left << setw(16) << stats.HitRatio() << '|' << endl;
+  std::cout << "+-------------------------------+-----------------+" << endl;
+  return DB_SUCCESS;
+}
+
 dberr_t ExecuteEngine::ExecuteUseDatabase(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteUseDatabase" << std::endl;
@@ -744,51 +832,55 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
       Map.push_back(i);
     }
   }
-  // 3. Exist Condition StateMent
-  clock_t out_diff;
-  if (ast->child_->next_->next_ != nullptr) {
-    clock_t start, end;
-    start = clock();
-    GetSatifedRowSet(ast, TableName, Current_Ctr, Result);
-    end = clock();
-    clock_t diff = end - start;
-    out_diff = diff;
-  }
-
-  else {
-    // 4.Not Exist the Condition StateMent- Get All Row
-    for (auto iter = CurTableInfo->GetTableHeap()->Begin(nullptr); iter != CurTableInfo->GetTableHeap()->End();
-         ++iter) {
-      Result.push_back(iter->GetRowId());
-    }
-  }
   // Print the Table Name
   std::cout << "+-------------------------------------+" << endl;
   std::cout << "| " << left << setw(36) << TableName << '|' << endl;
   std::cout << "+-------------------------------------+" << endl;
 
   Schema *CurSchema = CurTableInfo->GetSchema();
-  std::vector<Column *> CurColumns = CurSchema->GetColumns();
+  const std::vector<Column *> &CurColumns = CurSchema->GetColumns();
 
   for (auto i : Map) {
     std::cout << left << setw(12) << CurColumns[i]->GetName() << "\t";
   }
 
   std::cout << endl;
-  std::vector<Field *> Fields;
-  // Row Result Stored in the Vector
-  for (auto iter : Result) {
-    Row NewRow(iter);
-    CurTableHeap->GetTuple(&NewRow, nullptr);
-    Fields = NewRow.GetFields();
-
-    for (auto i : Map) {
+  // Only the columns of the Map are read out of the tuples, the Fields of the Row follow the order of the Map
+  auto PrintRow = [&](Row &NewRow) {
+    for (auto field : NewRow.GetFields()) {
       string Data;
-      Fields[i]->GetDataToString(Data);
+      field->GetDataToString(Data);
       std::cout << left << setw(12) << Data << "\t";
     }
     state = DB_SUCCESS;
     std::cout << endl;
+  };
+  // 3. Exist Condition StateMent
+  clock_t out_diff = 0;
+  if (ast->child_->next_->next_ != nullptr) {
+    clock_t start, end;
+    start = clock();
+    GetSatifedRowSet(ast, TableName, Current_Ctr, Result);
+    end = clock();
+    clock_t diff = end - start;
+    out_diff = diff;
+    // Row Result Stored in the Vector
+    for (auto iter : Result) {
+      Row NewRow(iter);
+      CurTableHeap->GetTuple(&NewRow, nullptr, &Map);
+      PrintRow(NewRow);
+    }
+  }
+
+  else {
+    // 4.Not Exist the Condition StateMent- Print All Row while scanning
+    // read the table through a small ring of frames, the full scan should not evict the working set.
+    BufferAccessStrategy strategy(BULK_READ_RING_SIZE);
+    for (auto iter = CurTableHeap->Begin(nullptr, &strategy); iter != CurTableHeap->End(); ++iter) {
+      Row NewRow(iter.View().GetRowId());
+      iter.View().ToRow(&NewRow, &Map);
+      PrintRow(NewRow);
+    }
   }
   std::cout << "+-------------------------------------+" << endl;
   printf("\n\nThe total time of selection is: %ld ticks\n\n", out_diff);
@@ -887,9 +979,11 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
         // Traverse the TableHeap to Check the New Inserted Column is Unique or Not
         if (Columns[CurPosition]->IsUnique() == true) {
           TableHeap *CurTableHeap = CurTableInfo->GetTableHeap();
-          for (TableIterator iter = CurTableHeap->Begin(nullptr); iter != CurTableHeap->End(); iter++) {
+          // the check reads the whole table, through a small ring of frames.
+          BufferAccessStrategy strategy(BULK_READ_RING_SIZE);
+          for (TableIterator iter = CurTableHeap->Begin(nullptr, &strategy); iter != CurTableHeap->End(); iter++) {
             // if there is value in the Table Heap is Equal with the NewInserted Tuple
-            if (iter->GetField(CurPosition)->CompareEquals(Fields[CurPosition]) == kTrue) {
+            if (iter.View().GetField(CurPosition).CompareEquals(Fields[CurPosition]) == kTrue) {
               state = DB_FAILED;
               break;
             }
@@ -899,34 +993,15 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
           return state;
         }
       }
-      // 4. Insert Tuple
+      // 4. Insert Tuple, an insert statement gives a batch of one row
       TableHeap *CurTableHeap = CurTableInfo->GetTableHeap();
-      Row NewRow(Fields);
-      bool InsertState = CurTableHeap->InsertTuple(NewRow, nullptr);
+      std::vector<Row> NewRows;
+      NewRows.emplace_back(Fields);
+      bool InsertState = CurTableHeap->InsertTuples(NewRows, nullptr);
 
       if (InsertState) {
         // 5. Update the Index to The Correspoding the Index
-        // Step1- Get All Index From the Correspoding TableName
-        std::vector<std::string> IndexName;
-        dberr_t state = Current_Ctr->GetAllIndexNames(TableName, IndexName);
-        if (state != DB_INDEX_NOT_FOUND) {
-          // There are Index for the Table needed to Update
-          for (std::vector<std::string>::iterator iter = IndexName.begin(); iter != IndexName.end(); iter++) {
-            IndexInfo *index_info = nullptr;
-            if (Current_Ctr->GetIndex(TableName, (*iter), index_info) == DB_SUCCESS) {
-              // Get the KeyMap
-              std::vector<uint32_t> KeyMap = index_info->GetMetaData()->GetKeyMapping();
-              std::vector<Field> fields;
-              // Using the KeyMap to GetField In order to Get the Key Schema
-              for (std::vector<uint32_t>::iterator iter = KeyMap.begin(); iter != KeyMap.end(); iter++) {
-                fields.push_back(*(NewRow.GetField(KeyMap[(*iter)])));
-              }
-              Row IndexRow(fields);
-              RowId rid(NewRow.GetRowId());
-              index_info->GetIndex()->InsertEntry(IndexRow, NewRow.GetRowId(), nullptr);
-            }
-          }
-        }
+        InsertIntoIndexes(Current_Ctr, TableName, NewRows);
         return DB_SUCCESS;
 
       } else {
@@ -1027,14 +1102,14 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
       // there is a connector
       if (connect_logic == std::string("and")) {
         for (auto i = tbl_heap->Begin(nullptr); i != tbl_heap->End(); ++i) {
-          RowId cur_rowid = i->GetRowId();
+          RowId cur_rowid = i.View().GetRowId();
           uint32_t idx_field_l, idx_field_r;
           tbl_schema->GetColumnIndex(left_col_name,
                                      idx_field_l);  // ignore the error handling, note that if you input a
           tbl_schema->GetColumnIndex(right_col_name,
                                      idx_field_r);  // col_name that does not exist will cause severe error !!!
-          Field *desired_field_l = i->GetField(idx_field_l);
-          Field *desired_field_r = i->GetField(idx_field_r);
+          Field desired_field_l = i.View().GetField(idx_field_l);
+          Field desired_field_r = i.View().GetField(idx_field_r);
           TypeId type_l = tbl_schema->GetColumn(idx_field_l)->GetType();
           TypeId type_r = tbl_schema->GetColumn(idx_field_r)->GetType();
           uint32_t length_l = tbl_schema->GetColumn(idx_field_l)->GetLength();
@@ -1056,27 +1131,27 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
           }
           bool left_rst = false;
           if (left_compare == std::string("=")) {
-            if (desired_field_l->CompareEquals(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareEquals(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           } else if (left_compare == std::string(">")) {
-            if (desired_field_l->CompareGreaterThan(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareGreaterThan(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           } else if (left_compare == std::string("<")) {
-            if (desired_field_l->CompareLessThan(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareLessThan(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           } else if (left_compare == std::string(">=")) {
-            if (desired_field_l->CompareGreaterThanEquals(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareGreaterThanEquals(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           } else if (left_compare == std::string("<=")) {
-            if (desired_field_l->CompareLessThanEquals(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareLessThanEquals(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           } else if (left_compare == std::string("<>")) {
-            if (desired_field_l->CompareNotEquals(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareNotEquals(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           } else {
@@ -1085,27 +1160,27 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
 
           bool right_rst = false;
           if (right_compare == std::string("=")) {
-            if (desired_field_r->CompareEquals(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareEquals(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           } else if (right_compare == std::string(">")) {
-            if (desired_field_r->CompareGreaterThan(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareGreaterThan(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           } else if (right_compare == std::string("<")) {
-            if (desired_field_r->CompareLessThan(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareLessThan(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           } else if (right_compare == std::string(">=")) {
-            if (desired_field_r->CompareGreaterThanEquals(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareGreaterThanEquals(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           } else if (right_compare == std::string("<=")) {
-            if (desired_field_r->CompareLessThanEquals(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareLessThanEquals(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           } else if (right_compare == std::string("<>")) {
-            if (desired_field_r->CompareNotEquals(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareNotEquals(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           } else {
@@ -1135,14 +1210,14 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
         }
       } else if (connect_logic == std::string("or")) {
         for (auto i = tbl_heap->Begin(nullptr); i != tbl_heap->End(); ++i) {
-          RowId cur_rowid = i->GetRowId();
+          RowId cur_rowid = i.View().GetRowId();
           uint32_t idx_field_l, idx_field_r;
           tbl_schema->GetColumnIndex(left_col_name,
                                      idx_field_l);  // ignore the error handling, note that if you input a
           tbl_schema->GetColumnIndex(right_col_name,
                                      idx_field_r);  // col_name that does not exist will cause severe error !!!
-          Field *desired_field_l = i->GetField(idx_field_l);
-          Field *desired_field_r = i->GetField(idx_field_r);
+          Field desired_field_l = i.View().GetField(idx_field_l);
+          Field desired_field_r = i.View().GetField(idx_field_r);
           TypeId type_l = tbl_schema->GetColumn(idx_field_l)->GetType();
           TypeId type_r = tbl_schema->GetColumn(idx_field_r)->GetType();
           uint32_t length_l = tbl_schema->GetColumn(idx_field_l)->GetLength();
@@ -1164,54 +1239,54 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
           }
           bool left_rst = false;
           if (left_compare == std::string("=")) {
-            if (desired_field_l->CompareEquals(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareEquals(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           } else if (left_compare == std::string(">")) {
-            if (desired_field_l->CompareGreaterThan(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareGreaterThan(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           } else if (left_compare == std::string("<")) {
-            if (desired_field_l->CompareLessThan(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareLessThan(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           } else if (left_compare == std::string(">=")) {
-            if (desired_field_l->CompareGreaterThanEquals(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareGreaterThanEquals(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           } else if (left_compare == std::string("<=")) {
-            if (desired_field_l->CompareLessThanEquals(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareLessThanEquals(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           } else if (left_compare == std::string("<>")) {
-            if (desired_field_l->CompareNotEquals(storage_l.front()) == CmpBool::kTrue) {
+            if (desired_field_l.CompareNotEquals(storage_l.front()) == CmpBool::kTrue) {
               left_rst = true;
             }
           }
 
           bool right_rst = false;
           if (right_compare == std::string("=")) {
-            if (desired_field_r->CompareEquals(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareEquals(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           } else if (right_compare == std::string(">")) {
-            if (desired_field_r->CompareGreaterThan(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareGreaterThan(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           } else if (right_compare == std::string("<")) {
-            if (desired_field_r->CompareLessThan(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareLessThan(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           } else if (right_compare == std::string(">=")) {
-            if (desired_field_r->CompareGreaterThanEquals(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareGreaterThanEquals(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           } else if (right_compare == std::string("<=")) {
-            if (desired_field_r->CompareLessThanEquals(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareLessThanEquals(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           } else if (right_compare == std::string("<>")) {
-            if (desired_field_r->CompareNotEquals(storage_r.front()) == CmpBool::kTrue) {
+            if (desired_field_r.CompareNotEquals(storage_r.front()) == CmpBool::kTrue) {
               right_rst = true;
             }
           }
@@ -1240,11 +1315,11 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
     } else {
       // there is no connector, only one condition
       for (auto i = tbl_heap->Begin(nullptr); i != tbl_heap->End(); ++i) {
-        RowId cur_rowid = i->GetRowId();
+        RowId cur_rowid = i.View().GetRowId();
         uint32_t idx_field;
         tbl_schema->GetColumnIndex(col_name, idx_field);  // ignore the error handling, note that if you input a
                                                           // col_name that does not exist will cause severe error !!!
-        Field *desired_field = i->GetField(idx_field);
+        Field desired_field = i.View().GetField(idx_field);
         TypeId type = tbl_schema->GetColumn(idx_field)->GetType();
         uint32_t length = tbl_schema->GetColumn(idx_field)->GetLength();
         std::vector<Field> storage;
@@ -1256,7 +1331,7 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
           storage.push_back(Field(TypeId::kTypeFloat, (float)atof(value.c_str())));
         }
         if (single_compare == std::string("=")) {
-          if (desired_field->CompareEquals(storage.front()) == CmpBool::kTrue) {
+          if (desired_field.CompareEquals(storage.front()) == CmpBool::kTrue) {
             tbl_heap->MarkDelete(cur_rowid, nullptr);
             if (rst_getidx == DB_INDEX_NOT_FOUND) {
               // no need to do the index refresh
@@ -1277,7 +1352,7 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
             }
           }
         } else if (single_compare == std::string(">=")) {
-          if (desired_field->CompareGreaterThanEquals(storage.front()) == CmpBool::kTrue) {
+          if (desired_field.CompareGreaterThanEquals(storage.front()) == CmpBool::kTrue) {
             tbl_heap->MarkDelete(cur_rowid, nullptr);
             if (rst_getidx == DB_INDEX_NOT_FOUND) {
               // no need to do the index refresh
@@ -1298,7 +1373,7 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
             }
           }
         } else if (single_compare == std::string("<=")) {
-          if (desired_field->CompareLessThanEquals(storage.front()) == CmpBool::kTrue) {
+          if (desired_field.CompareLessThanEquals(storage.front()) == CmpBool::kTrue) {
             tbl_heap->MarkDelete(cur_rowid, nullptr);
             if (rst_getidx == DB_INDEX_NOT_FOUND) {
               // no need to do the index refresh
@@ -1319,7 +1394,7 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
             }
           }
         } else if (single_compare == std::string(">")) {
-          if (desired_field->CompareGreaterThan(storage.front()) == CmpBool::kTrue) {
+          if (desired_field.CompareGreaterThan(storage.front()) == CmpBool::kTrue) {
             tbl_heap->MarkDelete(cur_rowid, nullptr);
             if (rst_getidx == DB_INDEX_NOT_FOUND) {
               // no need to do the index refresh
@@ -1340,7 +1415,7 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
             }
           }
         } else if (single_compare == std::string("<")) {
-          if (desired_field->CompareLessThan(storage.front()) == CmpBool::kTrue) {
+          if (desired_field.CompareLessThan(storage.front()) == CmpBool::kTrue) {
             tbl_heap->MarkDelete(cur_rowid, nullptr);
             if (rst_getidx == DB_INDEX_NOT_FOUND) {
               // no need to do the index refresh
@@ -1361,7 +1436,7 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
             }
           }
         } else if (single_compare == std::string("<>")) {
-          if (desired_field->CompareNotEquals(storage.front()) == CmpBool::kTrue) {
+          if (desired_field.CompareNotEquals(storage.front()) == CmpBool::kTrue) {
             tbl_heap->MarkDelete(cur_rowid, nullptr);
             if (rst_getidx == DB_INDEX_NOT_FOUND) {
               // no need to do the index refresh
@@ -1389,7 +1464,7 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
     // note that delete must maintain indexes as well as table heap
     // 1. do the deletion in the table heap
     for (auto i = tbl_heap->Begin(nullptr); i != tbl_heap->End(); ++i) {
-      RowId cur_rowid = i->GetRowId();
+      RowId cur_rowid = i.View().GetRowId();
       if (tbl_heap->MarkDelete(cur_rowid, nullptr) == false) {
         std::cout << "Something wrong! Something can not be deleted!" << std::endl;
       }
@@ -0,0 +1,106 @@
+#ifndef MINISQL_ARC_REPLACER_H
+#define MINISQL_ARC_REPLACER_H
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy.
+ *
+ * The resident pages are kept in two LRU lists: T1 holds the pages accessed once since they were loaded (recency), T2
+ * the pages accessed again (frequency). The keys of the pages recently evicted from T1 and T2 are remembered in the
+ * ghost lists B1 and B2. A miss on a page of B1 means T1 is too small, a miss on a page of B2 means T2 is too small:
+ * the target size p of T1 is moved accordingly, and the victim is taken from T1 as long as T1 is larger than p. So a
+ * full scan only pushes the pages of T1 out, while the pages found again by the point lookups stay in T2.
+ *
+ * The buffer pool tells the replacer about the loaded pages with OnLoad, an Unpin is an access of the page, except the
+ * first one after the load.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_pages the maximum number of pages the ARCReplacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ARCReplacer.
+   */
+  ~ARCReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void PeekVictims(std::vector<frame_id_t> *frames, size_t max_num) override;
+
+  void OnLoad(frame_id_t frame_id, uint64_t page_key) override;
+
+  void OnDrop(frame_id_t frame_id) override;
+
+  /** @return the current target size of T1 */
+  size_t GetTargetSize();
+
+ private:
+  enum ListType { kNone = 0, kT1, kT2 };
+
+  struct FrameState {
+    ListType list_{kNone};
+    std::list<frame_id_t>::iterator pos_;  // position in T1 or T2
+    bool has_page_{false};
+    uint64_t page_key_{0};
+    bool evictable_{false};
+    bool fresh_{false};  // loaded and not unpinned yet, the next Unpin is not a re-access
+  };
+
+  struct GhostEntry {
+    bool in_b1_;
+    std::list<uint64_t>::iterator pos_;
+  };
+
+  /** @return whether the victims are taken from T1 first */
+  bool PreferT1() const;
+
+  /** @return the least recently used evictable frame of the list, INVALID_FRAME_ID if none */
+  frame_id_t FindEvictable(const std::list<frame_id_t> &list) const;
+
+  /** take the frame out of T1 or T2, and remember its page in B1 or B2 */
+  void Evict(frame_id_t frame_id);
+
+  /** take the frame out of T1 or T2 */
+  void Detach(frame_id_t frame_id);
+
+  /** put the frame at the most recently used end of the list */
+  void Attach(frame_id_t frame_id, ListType list);
+
+  void EraseGhost(std::unordered_map<uint64_t, GhostEntry>::iterator iter);
+
+  /** drop the oldest ghosts, so that |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c */
+  void TrimGhosts();
+
+ private:
+  std::mutex mutx_;  // lock for threads
+  size_t max_size;
+  size_t target_t1_{0};  // p, the target size of T1
+  size_t num_evictable_{0};
+  std::vector<FrameState> frames_;
+  std::list<frame_id_t> t1_;  // most recently used at front
+  std::list<frame_id_t> t2_;
+  std::list<uint64_t> b1_;    // most recently evicted at front
+  std::list<uint64_t> b2_;
+  std::unordered_map<uint64_t, GhostEntry> ghosts_;
+};
+
+#endif  // MINISQL_ARC_REPLACER_H
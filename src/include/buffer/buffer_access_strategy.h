@@ -0,0 +1,43 @@
+#ifndef MINISQL_BUFFER_ACCESS_STRATEGY_H
+#define MINISQL_BUFFER_ACCESS_STRATEGY_H
+
+#include <vector>
+
+#include "common/config.h"
+
+class BufferPoolManager;
+
+/**
+ * BufferAccessStrategy is a small private ring of frames used by a bulk read (large sequential scan) or a bulk load.
+ *
+ * A page miss made with a strategy recycles the frame the ring used ring_size misses ago, if that frame still holds
+ * the page the ring put there and nobody pins it. Only when the ring is not full yet, or its frame has been taken by
+ * someone else, is a victim taken from the free list or the replacer of the buffer pool. A scan therefore replaces at
+ * most ring_size frames of the working set, however many pages it reads. Hits are served from the buffer pool as usual.
+ *
+ * A strategy is used by one scan at a time, it is not thread safe. Destroying it leaves the pages in the buffer pool.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManager;
+
+ public:
+  explicit BufferAccessStrategy(size_t ring_size = BULK_READ_RING_SIZE) : ring_(ring_size == 0 ? 1 : ring_size) {}
+
+  ~BufferAccessStrategy() = default;
+
+  /** @return the number of frames of the ring */
+  size_t GetRingSize() const { return ring_.size(); }
+
+ private:
+  struct Slot {
+    BufferPoolManager *owner_{nullptr};  // the buffer pool instance of the frame, nullptr if the slot is empty
+    frame_id_t frame_id_{INVALID_FRAME_ID};
+    uint32_t tag_{0};                     // the disk manager of the page put into the frame by the ring
+    page_id_t page_id_{INVALID_PAGE_ID};  // the page put into the frame by the ring
+  };
+
+  std::vector<Slot> ring_;
+  size_t current_{0};  // the slot used by the last page miss
+};
+
+#endif  // MINISQL_BUFFER_ACCESS_STRATEGY_H
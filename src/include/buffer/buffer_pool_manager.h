@@ -1,49 +1,310 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <string>
 #include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <unordered_map>
 
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_array.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_guard.h"
+#include "buffer/page_table.h"
 #include "page/disk_file_meta_page.h"
 #include "page/page.h"
 #include "storage/disk_manager.h"
 
 using namespace std;  // only effective in this file scope, outside the cpp file is not effective.
 
+/**
+ * Reads the id of the next page of a page chain from the data of a page, used by the read-ahead of the buffer pool.
+ * @return INVALID_PAGE_ID at the end of the chain
+ */
+using NextPageIdFunc = page_id_t (*)(const char *page_data);
+
+/**
+ * A snapshot of the counters of a buffer pool, taken by BufferPoolManager::GetStats. The counters are read one by one
+ * without stopping the pool, so they may be off by the requests running at the same time.
+ */
+struct BufferPoolStats {
+  size_t pool_size_{0};          // number of frames
+  size_t fetch_hits_{0};         // FetchPage served from the pool
+  size_t fetch_misses_{0};       // FetchPage which had to read the page
+  size_t evictions_{0};          // pages replaced to load another page
+  size_t dirty_write_backs_{0};  // dirty pages written back (replacement, flusher, FlushPage(s))
+  size_t new_pages_{0};          // successful NewPage
+  size_t deleted_pages_{0};      // pages deleted by DeletePage
+  size_t pin_wait_failures_{0};  // FetchPage or NewPage failed because all the frames were pinned
+  size_t dirty_pages_{0};        // dirty pages in the pool now
+
+  BufferPoolStats &operator+=(const BufferPoolStats &other) {
+    pool_size_ += other.pool_size_;
+    fetch_hits_ += other.fetch_hits_;
+    fetch_misses_ += other.fetch_misses_;
+    evictions_ += other.evictions_;
+    dirty_write_backs_ += other.dirty_write_backs_;
+    new_pages_ += other.new_pages_;
+    deleted_pages_ += other.deleted_pages_;
+    pin_wait_failures_ += other.pin_wait_failures_;
+    dirty_pages_ += other.dirty_pages_;
+    return *this;
+  }
+
+  /** @return the ratio of the fetches served from the pool, 0 if there was no fetch */
+  double HitRatio() const {
+    size_t fetches = fetch_hits_ + fetch_misses_;
+    return fetches == 0 ? 0 : static_cast<double>(fetch_hits_) / fetches;
+  }
+};
+
 class BufferPoolManager {
+  friend class ParallelBufferPoolManager;
+  friend class SharedBufferPoolManager;
+
  public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  /**
+   * @param disk_manager the disk manager of the pages, registered with tag 0. nullptr for a pool shared by several
+   *                     databases, which is only used through SharedBufferPoolManager
+   * @param replacer_type the replacement policy used to choose the victim frames, LRU by default
+   * @param max_pool_size the number of frames the pool can grow to with Resize, pool_size if it is smaller
+   */
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager, ReplacerType replacer_type = kReplacerLRU,
+                             size_t max_pool_size = 0);
+
+  virtual ~BufferPoolManager();
+
+  virtual Page *FetchPage(page_id_t page_id);
+
+  /**
+   * Fetch the page, a page miss takes its frame from the ring of the strategy instead of the replacer.
+   * @param strategy the access strategy of a bulk read, nullptr to use the buffer pool as usual
+   */
+  virtual Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy);
+
+  /**
+   * @return false if the page is not pinned, or if it is dirty and the db file is read only (it is unpinned anyway)
+   */
+  virtual bool UnpinPage(page_id_t page_id, bool is_dirty);
+
+  virtual bool FlushPage(page_id_t page_id);
+
+  virtual void FlushAllPages(void);  // this function is added by myself
+
+  virtual Page *NewPage(page_id_t &page_id);
+
+  /**
+   * Create a new page in a frame taken from the ring of the strategy, used by a bulk load.
+   * @param strategy the access strategy of a bulk load, nullptr to use the buffer pool as usual
+   */
+  virtual Page *NewPage(page_id_t &page_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Create a new page allocated on disk near another page of the same object, see DiskManager::AllocatePage.
+   * @param near_page_id the previous page of a table heap, or the page of a B+ tree being split
+   */
+  virtual Page *NewPageNear(page_id_t &page_id, page_id_t near_page_id);
+
+  virtual bool DeletePage(page_id_t page_id);
+
+  virtual bool IsPageFree(page_id_t page_id);
+
+  virtual bool CheckAllUnpinned();
+
+  /**
+   * Start the background flusher thread, which writes the dirty and unpinned pages near the eviction end of the
+   * replacer back to disk ahead of time, so that a page miss seldom has to write a dirty victim before its read.
+   * The flusher runs every interval, or as soon as the number of dirty pages reaches the high watermark, and writes
+   * pages back until the number of dirty pages drops to the low watermark.
+   * @param low_watermark the number of dirty pages left in the pool by a round of the flusher
+   * @param high_watermark the number of dirty pages which wakes the flusher up before the interval is over
+   * @param scan_depth the number of frames at the eviction end of the replacer looked at by a round
+   * @param interval the time between two rounds of the flusher
+   */
+  virtual void StartBackgroundFlusher(size_t low_watermark, size_t high_watermark, size_t scan_depth,
+                                      std::chrono::milliseconds interval = std::chrono::milliseconds(
+                                          DEFAULT_FLUSHER_INTERVAL_MS));
+
+  /**
+   * Stop the background flusher thread and wait for it, do nothing if it is not running.
+   */
+  virtual void StopBackgroundFlusher();
+
+  /** @return the number of dirty pages in the buffer pool */
+  virtual size_t GetDirtyPageCount() { return dirty_pages_.load(); }
+
+  /**
+   * Read-ahead hint: load the pages of a page chain into the buffer pool in the background, so that the following
+   * FetchPage calls of a sequential scan are hits. The pages are read outside the buffer pool latch and are put into
+   * the replacer unpinned. Returns at once, the request is dropped if too many requests are pending.
+   * @param page_id the first page to load
+   * @param depth the number of pages of the chain to load
+   * @param next_of reads the id of the next page of the chain from the data of a page
+   */
+  virtual void PrefetchPages(page_id_t page_id, size_t depth, NextPageIdFunc next_of);
+
+  /**
+   * Wait until the read-ahead requests made so far have loaded their pages.
+   */
+  virtual void WaitForPrefetches();
+
+  /**
+   * Warm restart: write the ids of the resident pages into a sidecar file, the hottest first (the pinned pages, then
+   * the pages of the replacer from the most to the least recently used). Called at a clean shutdown.
+   * @return false if the file can not be written
+   */
+  virtual bool SaveResidentPages(const std::string &file_name);
+
+  /**
+   * Warm restart: load the pages listed in the sidecar file written by SaveResidentPages, as many as the pool can hold.
+   * The pages are read in batches sorted by page id, the coldest batch first, so that the hottest pages end up as the
+   * most recently used. The file is removed once read, it is only valid until the data is changed.
+   * @param background load the pages in a background thread, the first queries do not wait for the warm up
+   * @return the number of pages to be loaded
+   */
+  virtual size_t LoadResidentPages(const std::string &file_name, bool background);
+
+  /**
+   * Wait until the background warm up started by LoadResidentPages has loaded its pages. Returns at once if there is
+   * none. Not to be called concurrently with LoadResidentPages.
+   */
+  virtual void WaitForWarmUp();
+
+  /** @return the number of frames of the buffer pool */
+  virtual size_t GetPoolSize() const { return pool_size_; }
+
+  /**
+   * Grow or shrink the buffer pool at runtime. Growing adds free frames. Shrinking writes back and evicts the pages of
+   * the frames beyond the new size and gives their memory back; it is refused if one of these pages is pinned.
+   * @return false if the pool is not resized: the size is larger than the max pool size, or a page is pinned
+   */
+  virtual bool Resize(size_t pool_size);
+
+  /** @return a snapshot of the counters of the buffer pool */
+  virtual BufferPoolStats GetStats();
+
+  /**
+   * Fetch the page and return a guard which unpins it, an empty guard if the page can not be fetched.
+   * @param strategy the access strategy of a bulk read, nullptr to use the buffer pool as usual
+   */
+  BasicPageGuard FetchPageBasic(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Fetch the page and read latch it, the guard releases the latch and unpins the page.
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id);
+
+  /**
+   * Fetch the page and write latch it, the guard releases the latch and unpins the page. The guard is empty if the db
+   * file is read only.
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id);
+
+  /**
+   * @return true if the db file is opened read only: no page can be created, deleted or written
+   */
+  bool IsReadOnly() const { return disk_manager_ != nullptr && disk_manager_->IsReadOnly(); }
+
+  /**
+   * Create a new page and return a guard which unpins it, an empty guard if there is no frame for it.
+   */
+  BasicPageGuard NewPageGuarded(page_id_t &page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Create a new page allocated near near_page_id, see NewPageNear.
+   */
+  BasicPageGuard NewPageGuardedNear(page_id_t &page_id, page_id_t near_page_id);
+
+ protected:
+  /**
+   * Used by the buffer pool managers which only dispatch the requests to other instances, owns no frame.
+   */
+  explicit BufferPoolManager(DiskManager *disk_manager);
+
+  /**
+   * The implementations of the public interface for the pages of the disk manager registered with tag.
+   */
+  Page *fetch_page(uint32_t tag, page_id_t page_id, BufferAccessStrategy *strategy);
+
+  bool unpin_page(uint32_t tag, page_id_t page_id, bool is_dirty);
+
+  bool flush_page(uint32_t tag, page_id_t page_id);
+
+  void flush_all_pages(uint32_t tag);
+
+  Page *new_page(uint32_t tag, page_id_t &page_id, BufferAccessStrategy *strategy,
+                 page_id_t near_page_id = INVALID_PAGE_ID);
+
+  bool delete_page(uint32_t tag, page_id_t page_id);
+
+  bool is_page_free(uint32_t tag, page_id_t page_id);
 
-  ~BufferPoolManager();
+  bool check_all_unpinned(uint32_t tag);
 
-  Page *FetchPage(page_id_t page_id);
+  void prefetch_pages(uint32_t tag, page_id_t page_id, size_t depth, NextPageIdFunc next_of);
 
-  bool UnpinPage(page_id_t page_id, bool is_dirty);
+  bool save_resident_pages(uint32_t tag, const std::string &file_name);
 
-  bool FlushPage(page_id_t page_id);
+  size_t load_resident_pages(uint32_t tag, const std::string &file_name, bool background);
 
-  void FlushAllPages(void);  // this function is added by myself
+  /**
+   * Load one page of a chain for the read-ahead, nothing is done if the page is resident already.
+   * @return the id of the next page of the chain
+   */
+  virtual page_id_t prefetch_page(uint32_t tag, page_id_t page_id, NextPageIdFunc next_of);
 
-  Page *NewPage(page_id_t &page_id);
+  /**
+   * Collect the ids of the resident pages of the disk manager, the hottest first.
+   */
+  virtual void get_resident_pages(uint32_t tag, std::vector<page_id_t> *page_ids);
 
-  bool DeletePage(page_id_t page_id);
+  /**
+   * Load the pages of a warm restart, ordered from the hottest to the coldest.
+   */
+  virtual void warm_up(uint32_t tag, std::vector<page_id_t> page_ids);
 
-  bool IsPageFree(page_id_t page_id);
+  /**
+   * Stop the read-ahead and the warm up threads and drop the pending requests. Called by the dtors before the pool is
+   * destroyed.
+   */
+  void stop_prefetcher();
 
-  bool CheckAllUnpinned();
+  /**
+   * Share the buffer pool with another database.
+   * @return the tag of the disk manager, which is part of the keys of its pages
+   */
+  uint32_t register_disk_manager(DiskManager *disk_manager);
+
+  /**
+   * Write back and drop all the pages of the disk manager, and forget it. The frames are given back to the free list.
+   */
+  void unregister_disk_manager(uint32_t tag);
 
  private:
   /**
    * Allocate new page (operations like create index/table) For now just keep an increasing counter
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(uint32_t tag = 0, page_id_t near_page_id = INVALID_PAGE_ID);
 
   /**
    * Deallocate page (operations like drop index/table) Need bitmap in header page for tracking pages
    */
-  void DeallocatePage(page_id_t page_id);
+  void DeallocatePage(page_id_t page_id, uint32_t tag = 0);
+
+  /**
+   * @return the disk manager registered with tag, nullptr if there is none.
+   * The caller holds latch_ or registry_latch_.
+   */
+  DiskManager *get_disk_manager(uint32_t tag);
 
   /**
    * return state of the operation, and the frame_id (by pointer argument) from free_list or replacer
@@ -51,24 +312,134 @@ class BufferPoolManager {
    */
   bool find_victim_page(frame_id_t *frame_id);
 
+  /**
+   * Find the victim frame of a page miss made with a strategy: the frame of the current slot of the ring is recycled if
+   * it is still holding the page of the ring and is not pinned, otherwise a victim is found as usual and put into
+   * the slot. The caller records the new page in the slot with remember_page.
+   */
+  bool find_victim_page(frame_id_t *frame_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Record the page loaded into the frame of the current slot of the ring, do nothing if strategy is nullptr.
+   */
+  void remember_page(BufferAccessStrategy *strategy, uint32_t tag, page_id_t page_id);
+
   /**
    * Write the dirty page into disk, and refresh the meta data of page (data, is_dirty, page_id) and page_table
    * This function is added by myself.
    */
-  void update_page(Page *page, page_id_t new_page_id, frame_id_t new_frame_id);
+  void update_page(Page *page, uint32_t new_tag, page_id_t new_page_id, frame_id_t new_frame_id);
 
- private:
+  /**
+   * Put the page (already allocated on disk by the caller) into a frame, the page is pinned and zeroed.
+   * Used when the page id is decided before the buffer pool instance, e.g. by ParallelBufferPoolManager.
+   * @return nullptr if all the frames are pinned
+   */
+  Page *NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy = nullptr, uint32_t tag = 0);
+
+  /**
+   * Increase the pin count of a resident page without the buffer pool latch.
+   * @return false if the frame is free or being replaced, the caller needs to take the slow path
+   */
+  bool try_pin_page(Page *page);
+
+  /**
+   * Set the dirty flag of the page, and count the page as dirty if it was clean.
+   */
+  void mark_dirty(Page *page);
+
+  /**
+   * Clear the dirty flag of the page, and stop counting the page as dirty if it was dirty.
+   */
+  void mark_clean(Page *page);
+
+  /**
+   * Main loop of the background flusher thread.
+   */
+  void flusher_loop();
+
+  /**
+   * Write the pages of the frames which are dirty and not in use back to disk, without holding latch_ during the I/O.
+   * The writes are in flight together. Stops once the number of dirty pages drops to the low watermark.
+   * @param buffers the copies of the pages, room for frame_ids.size() pages
+   * @return the number of pages written
+   */
+  size_t write_back_frames(const std::vector<frame_id_t> &frame_ids, char *buffers);
+
+  /**
+   * Put a page read by the read-ahead into a frame, unpinned. Nothing is done if the page is resident already or all
+   * the frames are pinned. The caller holds registry_latch_.
+   * @param epoch write_back_epoch_ taken before the page was read
+   * @return false if a page has been written back since the read, the page read may be outdated and is dropped
+   */
+  bool install_page(uint32_t tag, page_id_t page_id, const char *buffer, uint64_t epoch);
+
+  /**
+   * Main loop of the read-ahead thread.
+   */
+  void prefetcher_loop();
+
+ protected:
  
-  size_t pool_size_;           // number of pages in buffer pool
-  Page *pages_;                // array of pages
+  std::atomic<size_t> pool_size_;  // number of pages in buffer pool, changed by Resize under latch_
+  FrameArray pages_;               // array of pages, in chunks which never move
   DiskManager *disk_manager_;  // pointer to the disk manager.
-  std::unordered_map<page_id_t, frame_id_t>
-      page_table_;  // to keep track of pages -> using HASH table to record the mapping between frame_id_t(in-memory)
-                    // and page_id_t(on-disk)
-  Replacer *replacer_;  // to find an unpinned page for replacement -> Here using the LRU replacer.
+  PageTable page_table_;       // to keep track of pages -> mapping between page_id_t(on-disk) and frame_id_t(in-memory)
+                               // striped hash table, so the hit path of FetchPage and UnpinPage needs no latch_
+  Replacer *replacer_;  // to find an unpinned page for replacement -> LRU, LRU-K, CLOCK or ARC, chosen in the ctor.
   std::list<frame_id_t>
       free_list_;          // to find a free page for replacement -> A doubly-linked list recording the free page.
-  recursive_mutex latch_;  // to protect shared data structure -> a lock on thread level.
+  recursive_mutex latch_;  // to protect free_list_ and the replacement of frames -> a lock on thread level.
+  std::mutex write_back_latch_;         // orders the page writes of FlushPage(s) and the background flusher
+  std::atomic<size_t> dirty_pages_{0};  // number of frames holding a dirty page
+
+  // statistics, updated with relaxed atomics, read by GetStats
+  std::atomic<size_t> fetch_hits_{0};
+  std::atomic<size_t> fetch_misses_{0};
+  std::atomic<size_t> evictions_{0};
+  std::atomic<size_t> dirty_write_backs_{0};
+  std::atomic<size_t> new_pages_{0};
+  std::atomic<size_t> deleted_pages_{0};
+  std::atomic<size_t> pin_wait_failures_{0};
+
+  // the disk managers sharing the pool, by tag. Changed under registry_latch_ (exclusive) and latch_, so reading it
+  // needs one of them. The background threads hold registry_latch_ (shared) while they use a disk manager.
+  std::unordered_map<uint32_t, DiskManager *> disk_managers_;
+  uint32_t next_tag_{1};  // tags are never reused, a late background read can not hit the next database
+  std::shared_mutex registry_latch_;
+  std::vector<uint32_t> frame_tags_;  // tag of the disk manager of the page in every frame
+
+  // background flusher
+  std::thread flusher_thread_;
+  std::mutex flusher_latch_;  // protects flusher_running_, used with flusher_cv_
+  std::condition_variable flusher_cv_;
+  bool flusher_running_{false};
+  std::atomic<size_t> flusher_high_watermark_{SIZE_MAX};
+  size_t flusher_low_watermark_{0};
+  size_t flusher_scan_depth_{0};
+  std::chrono::milliseconds flusher_interval_{DEFAULT_FLUSHER_INTERVAL_MS};
+
+  // read-ahead
+  struct PrefetchRequest {
+    uint32_t tag_;
+    page_id_t page_id_;
+    size_t depth_;
+    NextPageIdFunc next_of_;
+  };
+  static constexpr size_t MAX_PREFETCH_REQUESTS = 64;
+  std::thread prefetch_thread_;  // started by the first request
+  std::mutex prefetch_latch_;    // protects prefetch_queue_, prefetch_busy_ and prefetch_stopped_
+  std::condition_variable prefetch_cv_;
+  std::condition_variable prefetch_idle_cv_;  // notified when the queue is empty and no request is being loaded
+  std::deque<PrefetchRequest> prefetch_queue_;
+  bool prefetch_busy_{false};  // a request taken off the queue is being loaded
+  std::atomic<bool> prefetch_stopped_{false};  // also stops the warm up
+  std::thread warm_up_thread_;                 // loads the pages of a warm restart in the background
+  static constexpr size_t WARM_UP_BATCH_SIZE = 64;
+  static constexpr uint32_t WARM_UP_FILE_MAGIC = 0x4d53574d;
+  // increased (under latch_) every time a dirty page is written back by a replacement or a page is deleted. A page read
+  // by the read-ahead is dropped if it changed while the read was running, the data on disk may be outdated.
+  uint64_t write_back_epoch_{0};
 };
 
-#endif  // MINISQL_BUFFER_POOL_MANAGER_H
\ No newline at end of file
+#endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -0,0 +1,51 @@
+#ifndef MINISQL_CLOCK_REPLACER_H
+#define MINISQL_CLOCK_REPLACER_H
+
+#include <atomic>
+#include <memory>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * ClockReplacer implements the CLOCK (second chance) replacement policy.
+ *
+ * The state of every frame is a reference bit and an evictable flag stored in flat arrays indexed by frame_id, so Pin
+ * and Unpin are a few atomic operations without any allocation or latch. Victim sweeps the clock hand over the frames:
+ * an evictable frame with its reference bit set gets a second chance (the bit is cleared), the first evictable frame
+ * found with a cleared reference bit is the victim.
+ */
+class ClockReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ClockReplacer.
+   * @param num_pages the maximum number of pages the ClockReplacer will be required to store
+   */
+  explicit ClockReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ClockReplacer.
+   */
+  ~ClockReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void PeekVictims(std::vector<frame_id_t> *frames, size_t max_num) override;
+
+ private:
+  size_t max_size;
+  std::unique_ptr<std::atomic<bool>[]> ref_bits_;   // reference bit of every frame, set by Unpin
+  std::unique_ptr<std::atomic<bool>[]> evictable_;  // whether the frame is in the replacer
+  std::atomic<size_t> clock_hand_{0};               // next frame to be checked, taken modulo max_size
+  std::atomic<int64_t> size_{0};                    // number of evictable frames, may be off by the racing updates
+};
+
+#endif  // MINISQL_CLOCK_REPLACER_H
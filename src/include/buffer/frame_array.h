@@ -0,0 +1,56 @@
+#ifndef MINISQL_FRAME_ARRAY_H
+#define MINISQL_FRAME_ARRAY_H
+
+#include <memory>
+
+#include "common/config.h"
+#include "page/page.h"
+
+/**
+ * FrameArray holds the frames of a buffer pool in chunks of FRAME_CHUNK_SIZE frames. A frame never moves once its
+ * chunk is allocated, so the pool can grow or shrink at runtime while the users keep their Page pointers.
+ *
+ * The directory of chunks is allocated for the maximum number of frames at construction, the chunks are allocated by
+ * Grow and freed by Shrink. The buffer pool manager makes sure no frame of a freed chunk is in use.
+ */
+class FrameArray {
+ public:
+  static constexpr size_t FRAME_CHUNK_SIZE = 64;
+
+  explicit FrameArray(size_t max_frames)
+      : num_chunks_((max_frames + FRAME_CHUNK_SIZE - 1) / FRAME_CHUNK_SIZE),
+        chunks_(new std::unique_ptr<Page[]>[num_chunks_]) {}
+
+  ~FrameArray() = default;
+
+  Page &operator[](size_t frame_id) { return chunks_[frame_id / FRAME_CHUNK_SIZE][frame_id % FRAME_CHUNK_SIZE]; }
+
+  /** @return the number of frames the array can hold */
+  size_t GetMaxFrames() const { return num_chunks_ * FRAME_CHUNK_SIZE; }
+
+  /**
+   * Allocate the chunks holding the frames [0, num_frames).
+   */
+  void Grow(size_t num_frames) {
+    for (size_t i = 0; i * FRAME_CHUNK_SIZE < num_frames && i < num_chunks_; i++) {
+      if (chunks_[i] == nullptr) {
+        chunks_[i].reset(new Page[FRAME_CHUNK_SIZE]);
+      }
+    }
+  }
+
+  /**
+   * Free the chunks which hold no frame of [0, num_frames).
+   */
+  void Shrink(size_t num_frames) {
+    for (size_t i = (num_frames + FRAME_CHUNK_SIZE - 1) / FRAME_CHUNK_SIZE; i < num_chunks_; i++) {
+      chunks_[i].reset();
+    }
+  }
+
+ private:
+  size_t num_chunks_;
+  std::unique_ptr<std::unique_ptr<Page[]>[]> chunks_;
+};
+
+#endif  // MINISQL_FRAME_ARRAY_H
@@ -0,0 +1,70 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <deque>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The replacer keeps the timestamps of the last K accesses of every frame. The victim is the evictable frame whose
+ * backward K-distance (current time - time of the K-th most recent access) is the largest. Frames with less than K
+ * recorded accesses have an infinite backward K-distance, and among them the one with the oldest access is evicted
+ * first. Pages touched only once by a sequential scan therefore leave the pool before pages that are re-referenced,
+ * e.g. the upper levels of the B+ tree and the catalog pages.
+ *
+ * An access is recorded every time a frame becomes evictable (Unpin), that is every time a user releases the page.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of historical accesses used to compute the backward K-distance
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void PeekVictims(std::vector<frame_id_t> *frames, size_t max_num) override;
+
+ private:
+  /**
+   * Ordering key of an evictable frame in evictable_set_: | infinite distance(0) or not(1) | timestamp | frame_id |
+   * The smallest key is the next victim.
+   */
+  using EvictKey = std::tuple<int, size_t, frame_id_t>;
+
+  /** @return the ordering key of the frame computed from its access history */
+  EvictKey GetEvictKey(frame_id_t frame_id) const;
+
+ private:
+  std::mutex mutx_;                          // lock for threads
+  size_t k_;                                 // the K in LRU-K
+  size_t current_timestamp_{0};              // logical clock, increased by every recorded access
+  std::vector<std::deque<size_t>> history_;  // the last k access timestamps of every frame, oldest at front
+  std::vector<bool> evictable_;              // whether the frame is in evictable_set_
+  std::set<EvictKey> evictable_set_;         // evictable frames ordered by backward K-distance
+  size_t max_size;
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
@@ -35,6 +35,8 @@ class LRUReplacer : public Replacer {
 
   size_t Size() override;
 
+  void PeekVictims(std::vector<frame_id_t> *frames, size_t max_num) override;
+
  private:
   // add your own private member variables here
   std::mutex mutx_;                // lock for threads
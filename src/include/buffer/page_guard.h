@@ -0,0 +1,204 @@
+#ifndef MINISQL_PAGE_GUARD_H
+#define MINISQL_PAGE_GUARD_H
+
+#include <utility>
+
+#include "common/config.h"
+#include "page/page.h"
+
+class BufferPoolManager;
+
+/**
+ * BasicPageGuard holds the pin of a page fetched from a buffer pool, and unpins the page when it is dropped or
+ * destroyed, so that every return path of the caller releases the page exactly once.
+ *
+ * The guards are move-only. A move hands the pin over to another guard: the pointers are copied and the moved-from
+ * guard is emptied, nothing is asked from the buffer pool. An empty guard (the fetch failed, or it was moved from)
+ * converts to false and its Drop does nothing.
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+
+  BasicPageGuard(BufferPoolManager *bpm, page_id_t page_id, Page *page)
+      : bpm_(page == nullptr ? nullptr : bpm), page_(page), page_id_(page == nullptr ? INVALID_PAGE_ID : page_id) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+
+  BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+  BasicPageGuard(BasicPageGuard &&that) noexcept
+      : bpm_(that.bpm_), page_(that.page_), page_id_(that.page_id_), is_dirty_(that.is_dirty_) {
+    that.Clear();
+  }
+
+  /** The page held by this guard is unpinned first. */
+  BasicPageGuard &operator=(BasicPageGuard &&that) noexcept {
+    if (this != &that) {
+      Drop();
+      bpm_ = that.bpm_;
+      page_ = that.page_;
+      page_id_ = that.page_id_;
+      is_dirty_ = that.is_dirty_;
+      that.Clear();
+    }
+    return *this;
+  }
+
+  ~BasicPageGuard() { Drop(); }
+
+  /**
+   * Unpin the page now, the guard becomes empty.
+   */
+  void Drop();
+
+  /**
+   * Give the pin up without unpinning the page, the caller has to unpin it. Only for the code not ported to the
+   * guards yet.
+   * @return the page, nullptr if the guard is empty
+   */
+  Page *Release() {
+    Page *page = page_;
+    Clear();
+    return page;
+  }
+
+  /** The page will be unpinned as dirty. */
+  void SetDirty() { is_dirty_ = true; }
+
+  explicit operator bool() const { return page_ != nullptr; }
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  Page *GetPage() const { return page_; }
+
+  char *GetData() const { return page_->GetData(); }
+
+  /** @return the data of the page seen as T, without marking the page dirty */
+  template <class T>
+  T *As() const {
+    return reinterpret_cast<T *>(page_->GetData());
+  }
+
+  /** @return the data of the page seen as T, the page is marked dirty */
+  template <class T>
+  T *AsMut() {
+    is_dirty_ = true;
+    return reinterpret_cast<T *>(page_->GetData());
+  }
+
+ private:
+  void Clear() {
+    bpm_ = nullptr;
+    page_ = nullptr;
+    page_id_ = INVALID_PAGE_ID;
+    is_dirty_ = false;
+  }
+
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard holds the pin and the read latch of a page. The latch is released before the unpin.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /** The page must already be read latched. */
+  explicit ReadPageGuard(BasicPageGuard &&guard) : guard_(std::move(guard)) {}
+
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept {
+    if (this != &that) {
+      Drop();
+      guard_ = std::move(that.guard_);
+    }
+    return *this;
+  }
+
+  ~ReadPageGuard() { Drop(); }
+
+  void Drop() {
+    if (guard_) {
+      guard_.GetPage()->RUnlatch();
+      guard_.Drop();
+    }
+  }
+
+  explicit operator bool() const { return static_cast<bool>(guard_); }
+
+  page_id_t GetPageId() const { return guard_.GetPageId(); }
+
+  Page *GetPage() const { return guard_.GetPage(); }
+
+  const char *GetData() const { return guard_.GetData(); }
+
+  template <class T>
+  T *As() const {
+    return guard_.As<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard holds the pin and the write latch of a page. The latch is released before the unpin, the page is
+ * unpinned as dirty if it was accessed through AsMut or SetDirty.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /** The page must already be write latched. */
+  explicit WritePageGuard(BasicPageGuard &&guard) : guard_(std::move(guard)) {}
+
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept {
+    if (this != &that) {
+      Drop();
+      guard_ = std::move(that.guard_);
+    }
+    return *this;
+  }
+
+  ~WritePageGuard() { Drop(); }
+
+  void Drop() {
+    if (guard_) {
+      guard_.GetPage()->WUnlatch();
+      guard_.Drop();
+    }
+  }
+
+  void SetDirty() { guard_.SetDirty(); }
+
+  explicit operator bool() const { return static_cast<bool>(guard_); }
+
+  page_id_t GetPageId() const { return guard_.GetPageId(); }
+
+  Page *GetPage() const { return guard_.GetPage(); }
+
+  char *GetData() const { return guard_.GetData(); }
+
+  template <class T>
+  T *As() const {
+    return guard_.As<T>();
+  }
+
+  template <class T>
+  T *AsMut() {
+    return guard_.AsMut<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+};
+
+#endif  // MINISQL_PAGE_GUARD_H
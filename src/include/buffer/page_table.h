@@ -0,0 +1,81 @@
+#ifndef MINISQL_PAGE_TABLE_H
+#define MINISQL_PAGE_TABLE_H
+
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "common/config.h"
+
+/**
+ * Key of a page in the page table: | tag of the disk manager (32 bits) | page id (32 bits) |. A buffer pool shared by
+ * several databases tells their pages apart by the tag, a buffer pool of a single database uses tag 0.
+ */
+using PageKey = uint64_t;
+
+inline PageKey MakePageKey(uint32_t tag, page_id_t page_id) {
+  return (static_cast<uint64_t>(tag) << 32) | static_cast<uint32_t>(page_id);
+}
+
+/**
+ * PageTable maps the keys of the resident pages to their frame ids. The map is split into stripes, every stripe has its own
+ * reader-writer latch, so lookups never wait for a global lock and only wait for the writers of the same stripe.
+ *
+ * The frame found by Find is only stable while the callback runs: the buffer pool manager erases the mapping of a
+ * frame (under the exclusive latch of the stripe) before reusing it, so a callback which pins the frame keeps it.
+ */
+class PageTable {
+ public:
+  PageTable() = default;
+
+  ~PageTable() = default;
+
+  /**
+   * Look up the page, and call func(frame_id) under the shared latch of the stripe if it is found.
+   * @return true if the page is in the table
+   */
+  template <typename Func>
+  bool Find(PageKey key, Func &&func) {
+    Stripe &stripe = GetStripe(key);
+    std::shared_lock lock{stripe.latch_};
+    auto search = stripe.map_.find(key);
+    if (search == stripe.map_.end()) {
+      return false;
+    }
+    func(search->second);
+    return true;
+  }
+
+  /**
+   * @return true if the page is in the table, its frame id is returned through frame_id
+   */
+  bool Find(PageKey key, frame_id_t *frame_id) {
+    return Find(key, [frame_id](frame_id_t found) { *frame_id = found; });
+  }
+
+  void Insert(PageKey key, frame_id_t frame_id) {
+    Stripe &stripe = GetStripe(key);
+    std::unique_lock lock{stripe.latch_};
+    stripe.map_[key] = frame_id;
+  }
+
+  void Erase(PageKey key) {
+    Stripe &stripe = GetStripe(key);
+    std::unique_lock lock{stripe.latch_};
+    stripe.map_.erase(key);
+  }
+
+ private:
+  static constexpr size_t NUM_STRIPES = 16;
+
+  struct Stripe {
+    std::shared_mutex latch_;
+    std::unordered_map<PageKey, frame_id_t> map_;
+  };
+
+  Stripe &GetStripe(PageKey key) { return stripes_[(key ^ (key >> 32)) % NUM_STRIPES]; }
+
+ private:
+  Stripe stripes_[NUM_STRIPES];
+};
+
+#endif  // MINISQL_PAGE_TABLE_H
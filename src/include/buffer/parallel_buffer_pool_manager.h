@@ -0,0 +1,108 @@
+#ifndef MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+#define MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * ParallelBufferPoolManager shards the pages over several independent BufferPoolManager instances by page id.
+ * Every instance has its own page table, free list, replacer and latch, so the requests on pages of different
+ * instances never wait for each other. It can be used everywhere a BufferPoolManager is expected.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @param num_instances number of buffer pool instances
+   * @param pool_size number of frames of every instance
+   * @param max_pool_size number of frames every instance can grow to
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            ReplacerType replacer_type = kReplacerLRU, size_t max_pool_size = 0);
+
+  ~ParallelBufferPoolManager() override;
+
+  Page *FetchPage(page_id_t page_id) override;
+
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  void FlushAllPages(void) override;
+
+  /**
+   * The page id is allocated first, then the page is put into the instance responsible for it.
+   */
+  Page *NewPage(page_id_t &page_id) override;
+
+  /**
+   * The slots of the ring may hold frames of different instances, an instance only recycles its own frames.
+   */
+  Page *NewPage(page_id_t &page_id, BufferAccessStrategy *strategy) override;
+
+  Page *NewPageNear(page_id_t &page_id, page_id_t near_page_id) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  bool IsPageFree(page_id_t page_id) override;
+
+  bool CheckAllUnpinned() override;
+
+  /**
+   * Every instance runs its own flusher, the watermarks and the scan depth are given per instance.
+   */
+  void StartBackgroundFlusher(size_t low_watermark, size_t high_watermark, size_t scan_depth,
+                              std::chrono::milliseconds interval = std::chrono::milliseconds(
+                                  DEFAULT_FLUSHER_INTERVAL_MS)) override;
+
+  void StopBackgroundFlusher() override;
+
+  size_t GetDirtyPageCount() override;
+
+  /** @return the sum of the counters of the instances */
+  BufferPoolStats GetStats() override;
+
+  /**
+   * The frames are shared out evenly among the instances. An instance which can not shrink keeps its size, the others
+   * are resized anyway.
+   * @return false if one of the instances is not resized
+   */
+  bool Resize(size_t pool_size) override;
+
+  /** @return the total number of frames of all the instances */
+  size_t GetPoolSize() const override;
+
+ protected:
+  /**
+   * The pages of a chain may belong to different instances, the chain is followed by the read-ahead thread of the
+   * ParallelBufferPoolManager and every page is loaded by its own instance.
+   */
+  page_id_t prefetch_page(uint32_t tag, page_id_t page_id, NextPageIdFunc next_of) override;
+
+  /**
+   * The pages of the instances are interleaved, every instance has its own replacer order.
+   */
+  void get_resident_pages(uint32_t tag, std::vector<page_id_t> *page_ids) override;
+
+  /**
+   * The list is split by instance, keeping its order, and every instance loads its own pages.
+   */
+  void warm_up(uint32_t tag, std::vector<page_id_t> page_ids) override;
+
+ private:
+  /** @return the instance responsible for the page */
+  BufferPoolManager *GetInstance(page_id_t page_id) {
+    return instances_[static_cast<uint32_t>(page_id) % num_instances_];
+  }
+
+  /** allocate the page id (near near_page_id if valid), then put the page into its instance */
+  Page *new_page_near(page_id_t &page_id, page_id_t near_page_id, BufferAccessStrategy *strategy);
+
+ private:
+  size_t num_instances_;
+  std::vector<BufferPoolManager *> instances_;
+};
+
+#endif  // MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
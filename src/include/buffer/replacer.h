@@ -1,9 +1,22 @@
 #ifndef MINISQL_REPLACER_H
 #define MINISQL_REPLACER_H
 
+#include <cstdint>
 #include <cstdio>
+#include <vector>
+
 #include "common/config.h"
 
+/**
+ * The replacement policies which can be chosen when the buffer pool manager is constructed.
+ */
+enum ReplacerType {
+  kReplacerLRU = 0,  /** least recently used */
+  kReplacerLRUK,     /** LRU-K, scan resistant */
+  kReplacerClock,    /** CLOCK, reference bits in flat arrays */
+  kReplacerARC,      /** ARC, adapts between recency and frequency */
+};
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -34,6 +47,26 @@ public:
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  /**
+   * Look at the frames which are going to be victimized next, without removing them. Used by the background flusher
+   * of the buffer pool manager to write the dirty pages back before they are chosen as victims.
+   * @param[out] frames the candidate frames, in the order they would be victimized
+   * @param max_num the maximum number of candidates
+   */
+  virtual void PeekVictims(std::vector<frame_id_t> * /*frames*/, size_t /*max_num*/) {}
+
+  /**
+   * A new page is put into the frame, which comes from the free list or has just been chosen as a victim. Used by the
+   * policies which remember the recently evicted pages (ARC).
+   * @param page_key identifies the page among all the pages of the buffer pool
+   */
+  virtual void OnLoad(frame_id_t /*frame_id*/, uint64_t /*page_key*/) {}
+
+  /**
+   * The page of the frame is dropped (deleted), the frame goes back to the free list.
+   */
+  virtual void OnDrop(frame_id_t /*frame_id*/) {}
 };
 
 #endif  // MINISQL_REPLACER_H
@@ -0,0 +1,91 @@
+#ifndef MINISQL_SHARED_BUFFER_POOL_MANAGER_H
+#define MINISQL_SHARED_BUFFER_POOL_MANAGER_H
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * SharedBufferPoolManager is the view of one database on a buffer pool shared by all the open databases.
+ *
+ * The view owns no frame. Its disk manager is registered with the shared pool, which keys the pages by (tag of the disk
+ * manager, page_id), so the databases compete for the same frames: an idle database gives its frames to a busy one by
+ * the usual replacement. Destroying the view writes back and drops the pages of its database, the shared pool must
+ * outlive all its views. It can be used everywhere a BufferPoolManager is expected.
+ */
+class SharedBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @param pool the shared buffer pool, created with a nullptr disk manager
+   * @param disk_manager the disk manager of the database
+   */
+  SharedBufferPoolManager(BufferPoolManager *pool, DiskManager *disk_manager);
+
+  ~SharedBufferPoolManager() override;
+
+  Page *FetchPage(page_id_t page_id) override;
+
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  /**
+   * Only the pages of this database are written.
+   */
+  void FlushAllPages(void) override;
+
+  Page *NewPage(page_id_t &page_id) override;
+
+  Page *NewPage(page_id_t &page_id, BufferAccessStrategy *strategy) override;
+
+  Page *NewPageNear(page_id_t &page_id, page_id_t near_page_id) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  bool IsPageFree(page_id_t page_id) override;
+
+  bool CheckAllUnpinned() override;
+
+  /**
+   * The flusher belongs to the shared pool and writes the pages of all the databases.
+   */
+  void StartBackgroundFlusher(size_t low_watermark, size_t high_watermark, size_t scan_depth,
+                              std::chrono::milliseconds interval = std::chrono::milliseconds(
+                                  DEFAULT_FLUSHER_INTERVAL_MS)) override;
+
+  void StopBackgroundFlusher() override;
+
+  /** @return the number of dirty pages of all the databases */
+  size_t GetDirtyPageCount() override;
+
+  /** @return the counters of the shared pool, the requests of all the databases are counted */
+  BufferPoolStats GetStats() override { return pool_->GetStats(); }
+
+  void PrefetchPages(page_id_t page_id, size_t depth, NextPageIdFunc next_of) override;
+
+  /** Also waits for the read-ahead of the other databases of the pool. */
+  void WaitForPrefetches() override { pool_->WaitForPrefetches(); }
+
+  /**
+   * Only the pages of this database are saved.
+   */
+  bool SaveResidentPages(const std::string &file_name) override;
+
+  size_t LoadResidentPages(const std::string &file_name, bool background) override;
+
+  void WaitForWarmUp() override { pool_->WaitForWarmUp(); }
+
+  /** @return the number of frames of the shared pool */
+  size_t GetPoolSize() const override { return pool_->GetPoolSize(); }
+
+  /**
+   * Resize the shared pool, all the databases are affected.
+   */
+  bool Resize(size_t pool_size) override { return pool_->Resize(pool_size); }
+
+ private:
+  BufferPoolManager *pool_;
+  uint32_t tag_;  // tag of the disk manager in the shared pool
+};
+
+#endif  // MINISQL_SHARED_BUFFER_POOL_MANAGER_H
@@ -17,8 +17,12 @@ public:
 
   static uint32_t DeserializeFrom(char *buf, TableMetadata *&table_meta, MemHeap *heap);
 
+  /**
+   * @param free_space_map_page_id the root page of the free space map of the table heap
+   */
   static TableMetadata *Create(table_id_t table_id, std::string table_name,
-                               page_id_t root_page_id, TableSchema *schema, MemHeap *heap);
+                               page_id_t root_page_id, TableSchema *schema, MemHeap *heap,
+                               page_id_t free_space_map_page_id = INVALID_PAGE_ID);
 
   inline table_id_t GetTableId() const { return table_id_; }
 
@@ -28,16 +32,23 @@ public:
 
   inline Schema *GetSchema() const { return schema_; }
 
+  /** @return INVALID_PAGE_ID for a table written before the free space map */
+  inline page_id_t GetFreeSpaceMapPageId() const { return free_space_map_page_id_; }
+
 private:
   TableMetadata() = delete;
 
-  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                page_id_t free_space_map_page_id);
 
 private:
   static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
+  // the metadata holds the root page of the free space map after the root page id
+  static constexpr uint32_t TABLE_METADATA_FSM_MAGIC_NUM = 344529;
   table_id_t table_id_;
   std::string table_name_;
   page_id_t root_page_id_;
+  page_id_t free_space_map_page_id_;
   Schema *schema_;
 };
 
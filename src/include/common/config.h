@@ -15,6 +15,16 @@ static constexpr int INDEX_ROOTS_PAGE_ID = 1;        // logical page id of the i
 
 static constexpr int PAGE_SIZE = 4096;               // size of a data page in byte
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 1024;// default size of buffer pool
+static constexpr int DEFAULT_BUFFER_POOL_INSTANCES = 1;// default number of buffer pool instances
+static constexpr int LRUK_REPLACER_K = 2;            // default K of the LRU-K replacer
+static constexpr int DEFAULT_FLUSHER_INTERVAL_MS = 100;// default interval of the background flusher in ms
+static constexpr int TABLE_READ_AHEAD_PAGES = 8;     // number of table pages loaded ahead by a sequential scan
+static constexpr int BULK_READ_RING_SIZE = 32;       // number of frames of the ring used by a bulk read
+static constexpr size_t DEFAULT_BUFFER_POOL_BYTES = 16 * 1024 * 1024;// default memory budget of the buffer pool shared by the databases
+static constexpr size_t BUFFER_POOL_MAX_GROWTH = 4;  // the shared buffer pool can grow to this many times its initial size
+static constexpr size_t ASYNC_IO_QUEUE_DEPTH = 64;   // max number of asynchronous page I/Os in flight per db file
+static constexpr size_t ASYNC_IO_THREADS = 4;        // number of threads of the asynchronous I/O without io_uring
+static constexpr size_t FILE_GROWTH_CHUNK_PAGES = 4096;// the db file is preallocated this many pages at a time
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;    // max length of varchar
@@ -1,10 +1,13 @@
 #ifndef MINISQL_INSTANCE_H
 #define MINISQL_INSTANCE_H
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "buffer/shared_buffer_pool_manager.h"
 #include "catalog/catalog.h"
 #include "common/config.h"
 #include "common/dberr.h"
@@ -12,19 +15,66 @@
 #include"page/index_roots_page.h"
 class DBStorageEngine {
 public:
+  /**
+   * @param buffer_pool_instances with more than one instance, the frames are shared out among the instances of a
+   *                              ParallelBufferPoolManager, so that the page accesses from several threads
+   *                              do not wait for a single latch. There are at most buffer_pool_size instances.
+   * @param read_only open an existing db file read only (e.g. a copy used by a reporting replica): the file is mapped
+   *                  in memory and its pages are used in place by the buffer pool, nothing is written. init is ignored.
+   */
   explicit DBStorageEngine(std::string db_name, bool init = true,
-                           uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE)
-          : db_file_name_(std::move(db_name)), init_(init) {
+                           uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE,
+                           uint32_t buffer_pool_instances = DEFAULT_BUFFER_POOL_INSTANCES, bool read_only = false)
+          : db_file_name_(std::move(db_name)), init_(init && !read_only), read_only_(read_only) {
     // Init database file if needed
     if (init_) {
       remove(db_file_name_.c_str());
+      remove(GetWarmUpFileName().c_str());
     }
     // Initialize components
-    disk_mgr_ = new DiskManager(db_file_name_);
-    bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
-    catalog_mgr_ = new CatalogManager(bpm_, nullptr, nullptr, init);
+    disk_mgr_ = new DiskManager(db_file_name_, read_only_ ? kDiskIOMmapReadOnly : kDiskIOPositioned);
+    // every instance gets at least one frame.
+    buffer_pool_instances = std::min(buffer_pool_instances, buffer_pool_size);
+    if (buffer_pool_instances > 1) {
+      bpm_ = new ParallelBufferPoolManager(buffer_pool_instances, buffer_pool_size / buffer_pool_instances, disk_mgr_);
+    } else {
+      bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+    }
+    InitStorage();
+  }
+
+  /**
+   * @param shared_pool a buffer pool shared with the other open databases, created with a nullptr disk manager. The
+   *                    database only holds a SharedBufferPoolManager view on it, the pool must outlive the database.
+   */
+  DBStorageEngine(std::string db_name, BufferPoolManager *shared_pool, bool init = true, bool read_only = false)
+          : db_file_name_(std::move(db_name)), init_(init && !read_only), read_only_(read_only) {
+    if (init_) {
+      remove(db_file_name_.c_str());
+      remove(GetWarmUpFileName().c_str());
+    }
+    disk_mgr_ = new DiskManager(db_file_name_, read_only_ ? kDiskIOMmapReadOnly : kDiskIOPositioned);
+    bpm_ = new SharedBufferPoolManager(shared_pool, disk_mgr_);
+    InitStorage();
+  }
+
+  ~DBStorageEngine() {
+    delete catalog_mgr_;
+    if (!read_only_) {
+      bpm_->SaveResidentPages(GetWarmUpFileName());
+    }
+    delete bpm_;
+    delete disk_mgr_;
+  }
+
+  /** @return the sidecar file keeping the resident pages of the buffer pool between two runs */
+  std::string GetWarmUpFileName() const { return db_file_name_ + ".warm"; }
+
+private:
+  void InitStorage() {
+    catalog_mgr_ = new CatalogManager(bpm_, nullptr, nullptr, init_);
     // Allocate static page for db storage engine
-    if (init) {
+    if (init_) {
       page_id_t id;
       ASSERT(bpm_->IsPageFree(CATALOG_META_PAGE_ID), "Catalog meta page not free.");
       ASSERT(bpm_->IsPageFree(INDEX_ROOTS_PAGE_ID), "Header page not free.");
@@ -37,21 +87,21 @@ public:
     } else {
       ASSERT(!bpm_->IsPageFree(CATALOG_META_PAGE_ID), "Invalid catalog meta page.");
       ASSERT(!bpm_->IsPageFree(INDEX_ROOTS_PAGE_ID), "Invalid header page.");
+      // warm restart: load the pages which were resident at the last clean shutdown, without blocking the queries.
+      // A read only engine does not take the list, it is removed once read and belongs to the writer.
+      if (!read_only_) {
+        bpm_->LoadResidentPages(GetWarmUpFileName(), true);
+      }
     }
   }
 
-  ~DBStorageEngine() {
-    delete catalog_mgr_;
-    delete bpm_;
-    delete disk_mgr_;
-  }
-
 public:
   DiskManager *disk_mgr_;
   BufferPoolManager *bpm_;
   CatalogManager *catalog_mgr_;
   std::string db_file_name_;
   bool init_;
+  bool read_only_;  // the db file is opened read only, see DiskManager kDiskIOMmapReadOnly
 };
 
 #endif //MINISQL_INSTANCE_H
@@ -28,7 +28,11 @@ struct ExecuteContext {
  */
 class ExecuteEngine {
 public:
-  ExecuteEngine();
+  /**
+   * @param buffer_pool_bytes memory budget of the buffer pool shared by all the open databases, the frames of an idle
+   *                          database are reused by the busy ones
+   */
+  explicit ExecuteEngine(size_t buffer_pool_bytes = DEFAULT_BUFFER_POOL_BYTES);
 
   ~ExecuteEngine() {
     // add write back to file content.txt
@@ -50,6 +54,8 @@ public:
       delete it.second;
     }
     db_contents.close();
+    // the databases give their pages back to the shared pool when they are deleted.
+    delete shared_pool_;
   }
 
   /**
@@ -57,6 +63,13 @@ public:
    */
   dberr_t Execute(pSyntaxNode ast, ExecuteContext *context);
 
+  /**
+   * Change the memory budget of the shared buffer pool at runtime, e.g. give it more memory during a load job. The
+   * pool can grow up to BUFFER_POOL_MAX_GROWTH times its initial budget.
+   * @return false if the budget is too large, or the pool can not shrink because pages are in use
+   */
+  bool ResizeBufferPool(size_t buffer_pool_bytes);
+
 private:
   dberr_t ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *context);
 
@@ -74,6 +87,8 @@ private:
 
   dberr_t ExecuteShowIndexes(pSyntaxNode ast, ExecuteContext *context);
 
+  dberr_t ExecuteShowStatus(pSyntaxNode ast, ExecuteContext *context);
+
   dberr_t ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context);
@@ -99,6 +114,7 @@ private:
 private:
   std::unordered_map<std::string, DBStorageEngine *> dbs_;  /** all opened databases */
   std::string current_db_;  /** current database */
+  BufferPoolManager *shared_pool_;  /** buffer pool shared by all opened databases */
 };
 
 #endif //MINISQL_EXECUTE_ENGINE_H
@@ -94,6 +94,8 @@ private:
 
   bool AdjustRoot(BPlusTreePage *node);
 
+  BasicPageGuard FindLeafPageGuarded(const KeyType &key, bool leftMost = false);
+
   void UpdateRootPageId(bool insert_record = false);
 
   /* Debug Routines for FREE!! */
@@ -2,6 +2,8 @@
 #define MINISQL_BITMAP_PAGE_H
 
 #include <bitset>
+#include <cstdint>
+#include <cstring>
 
 #include "common/macros.h"
 #include "common/config.h"
@@ -9,6 +11,18 @@
 template<size_t PageSize>
 class BitmapPage {
 public:
+  /** Number of 64-bit words of the bitmap, the free pages are searched a word at a time. */
+  static constexpr size_t NUM_WORDS = (PageSize - 2 * sizeof(uint32_t)) / sizeof(uint64_t);
+
+  /**
+   * Summary of a bitmap page, one bit per word of the bitmap, set if the word has a free page. It is not part of the
+   * page: the owner of a cached bitmap page keeps it next to the page and passes it to every allocation, so that the
+   * search skips the full words without reading them.
+   */
+  struct Summary {
+    uint64_t words_[(NUM_WORDS + 63) / 64];
+  };
+
   /**
    * @return The number of pages that the bitmap page can record, i.e. the capacity of an extent.
    */
@@ -16,20 +30,35 @@ public:
 
   /**
    * @param page_offset Index in extent of the page allocated.
+   * @param summary the summary of this page, nullptr to scan the words of the bitmap
    * @return true if successfully allocate a page.
    */
-  bool AllocatePage(uint32_t &page_offset);
+  bool AllocatePage(uint32_t &page_offset, Summary *summary = nullptr);
+
+  /**
+   * Allocate the page goal if it is free, otherwise the first page of an empty word (64 free pages) after it, so that
+   * the pages allocated one after another near the same page are contiguous.
+   * @param goal index in extent of the page wanted
+   * @param page_offset Index in extent of the page allocated.
+   * @return false if neither is free, the caller allocates the page anywhere else
+   */
+  bool AllocatePageNear(uint32_t goal, uint32_t &page_offset, Summary *summary = nullptr);
 
   /**
    * @return true if successfully de-allocate a page.
    */
-  bool DeAllocatePage(uint32_t page_offset);
+  bool DeAllocatePage(uint32_t page_offset, Summary *summary = nullptr);
 
   /**
    * @return whether a page in the extent is free
    */
   bool IsPageFree(uint32_t page_offset) const;
 
+  /**
+   * Fill the summary of this page.
+   */
+  void BuildSummary(Summary *summary) const;
+
 private:
   /**
    * check a bit(byte_index, bit_index) in bytes is free(value 0).
@@ -40,13 +69,39 @@ private:
    */
   bool IsPageFreeLow(uint32_t byte_index, uint8_t bit_index) const;
 
+  /**
+   * Mark the free page allocated.
+   */
+  void SetAllocated(uint32_t page_offset, Summary *summary);
+
+  /**
+   * @return the first free page at or after from, GetMaxSupportedSize() if there is none
+   */
+  uint32_t FindFreePage(uint32_t from, const Summary *summary) const;
+
+  /**
+   * @return the word_index-th word of the bitmap, read as big endian: page i of the word is the bit 63 - i (the pages
+   * are recorded from the highest bit of each byte).
+   */
+  uint64_t LoadWord(size_t word_index) const {
+    uint64_t word;
+    memcpy(&word, bytes + word_index * sizeof(uint64_t), sizeof(uint64_t));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return __builtin_bswap64(word);
+#else
+    return word;
+#endif
+  }
+
   /** Note: need to update if modify page structure. */
   static constexpr size_t MAX_CHARS = PageSize - 2 * sizeof(uint32_t);
 
+  static_assert(MAX_CHARS % sizeof(uint64_t) == 0, "the bitmap is searched a word at a time");
+
 public:
   /** The space occupied by all members of the class should be equal to the PageSize */
   uint32_t page_allocated_=0;
-  uint32_t next_free_page_=0;
+  uint32_t next_free_page_=0;  // no page before it is free
   unsigned char bytes[MAX_CHARS];
 
 };
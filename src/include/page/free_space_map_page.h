@@ -0,0 +1,104 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "common/config.h"
+
+/**
+ * The free space map of a table heap records how much room is left on every page of the heap, so that an insert goes
+ * straight to a page with enough room instead of trying the pages of the heap one after another.
+ *
+ * The room of a page is kept as a category of one byte: category c means that a tuple of c * CATEGORY_BYTES bytes
+ * (its slot not counted) fits in the page. A leaf page holds the categories of LEAF_PAGES consecutive page ids, the
+ * pages which are not in the heap stay in category 0. The root page holds the leaf of every range of page ids in
+ * which the heap has a page, with an upper bound of the categories of the leaf.
+ *
+ * Root format (size in byte):
+ *  -------------------------------------------------------------------------------------------------------
+ * | LastPageId (4) | Leaf_0 page id (4) | ... | Leaf_K-1 page id (4) | Leaf_0 max (1) | ... | Leaf_K-1 max (1) |
+ *  -------------------------------------------------------------------------------------------------------
+ * Leaf format: | Category of the first page id (1) | ... | Category of the last page id (1) |
+ */
+class FreeSpaceMapRootPage {
+ public:
+  /**
+   * Number of leaves of the map. The page ids from MAX_LEAVES * LEAF_PAGES on are not recorded, the inserts fill the
+   * last page of the heap there, the room freed on the other pages past the map is not reused.
+   */
+  static constexpr uint32_t MAX_LEAVES = (PAGE_SIZE - sizeof(page_id_t)) / (sizeof(page_id_t) + sizeof(uint8_t));
+
+  void Init(page_id_t last_page_id);
+
+  /** @return the last page of the heap, new pages are linked after it */
+  page_id_t GetLastPageId() const { return last_page_id_; }
+
+  void SetLastPageId(page_id_t last_page_id) { last_page_id_ = last_page_id; }
+
+  page_id_t GetLeafPageId(uint32_t leaf_index) const { return leaf_page_ids_[leaf_index]; }
+
+  void SetLeafPageId(uint32_t leaf_index, page_id_t leaf_page_id) { leaf_page_ids_[leaf_index] = leaf_page_id; }
+
+  /** @return no page of the leaf has a higher category, the leaf may have none as high */
+  uint8_t GetLeafMax(uint32_t leaf_index) const { return leaf_max_[leaf_index]; }
+
+  void SetLeafMax(uint32_t leaf_index, uint8_t category) { leaf_max_[leaf_index] = category; }
+
+  /**
+   * @return the first leaf from from on whose upper bound is at least category, MAX_LEAVES if there is none
+   */
+  uint32_t FindLeaf(uint8_t category, uint32_t from) const;
+
+ private:
+  page_id_t last_page_id_;
+  page_id_t leaf_page_ids_[MAX_LEAVES];
+  uint8_t leaf_max_[MAX_LEAVES];
+};
+
+static_assert(sizeof(FreeSpaceMapRootPage) <= PAGE_SIZE, "the root of the free space map must fit in a page");
+
+class FreeSpaceMapLeafPage {
+ public:
+  /** Number of page ids recorded by a leaf. */
+  static constexpr uint32_t LEAF_PAGES = PAGE_SIZE;
+
+  /** Bytes of room between two categories. */
+  static constexpr uint32_t CATEGORY_BYTES = PAGE_SIZE / 256;
+
+  void Init() { memset(categories_, 0, sizeof(categories_)); }
+
+  uint8_t GetCategory(uint32_t index) const { return categories_[index]; }
+
+  void SetCategory(uint32_t index, uint8_t category) { categories_[index] = category; }
+
+  /**
+   * @return the first page of the leaf whose category is at least category, LEAF_PAGES if there is none
+   */
+  uint32_t FindPage(uint8_t category) const;
+
+  /** @return the highest category of the leaf */
+  uint8_t GetMaxCategory() const;
+
+  /**
+   * @param free_bytes bytes a tuple can take in the page, its slot not counted
+   * @return the category of the page, rounded down
+   */
+  static uint8_t ToCategory(uint32_t free_bytes) {
+    return static_cast<uint8_t>(free_bytes / CATEGORY_BYTES > 255 ? 255 : free_bytes / CATEGORY_BYTES);
+  }
+
+  /**
+   * @return the lowest category of the pages in which a tuple of tuple_size bytes fits, rounded up
+   */
+  static uint8_t NeededCategory(uint32_t tuple_size) {
+    return static_cast<uint8_t>((tuple_size + CATEGORY_BYTES - 1) / CATEGORY_BYTES);
+  }
+
+ private:
+  uint8_t categories_[LEAF_PAGES];
+};
+
+static_assert(sizeof(FreeSpaceMapLeafPage) == PAGE_SIZE, "a leaf of the free space map is a page");
+
+#endif  // MINISQL_FREE_SPACE_MAP_PAGE_H
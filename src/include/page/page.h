@@ -1,6 +1,7 @@
 #ifndef MINISQL_PAGE_H
 #define MINISQL_PAGE_H
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 #include <shared_mutex>
@@ -63,19 +64,33 @@ protected:
   static constexpr size_t SIZE_PAGE_HEADER = 8;
   static constexpr size_t OFFSET_PAGE_START = 0;
   static constexpr size_t OFFSET_LSN = 4;
+  static constexpr int FRAME_NOT_RESIDENT = -1;
 
 private:
-  /** Zeroes out the data that is held within the page. */
-  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
-
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** Zeroes out the data that is held within the page, a mapped page is given its frame back first. */
+  inline void ResetMemory() {
+    data_ = frame_data_;
+    memset(data_, OFFSET_PAGE_START, PAGE_SIZE);
+  }
+
+  /** @return true if the data is the page in the mapping of a read only db file, not the frame */
+  inline bool IsMapped() const { return data_ != frame_data_; }
+
+  /** The memory of the frame. */
+  char frame_data_[PAGE_SIZE]{};
+  /** The actual data that is stored within a page: the frame, or the page in the mapping of a read only db file. */
+  char *data_ = frame_data_;
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /**
+   * The pin count of this page. Changed without the buffer pool latch by the buffer pool hit path, a negative value
+   * (FRAME_NOT_RESIDENT) means the frame is free or being replaced and can not be pinned.
+   */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /** Set when the page is pinned by the buffer pool hit path, the replacer is told at the next unpin. */
+  std::atomic<bool> referenced_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
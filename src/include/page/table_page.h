@@ -44,6 +44,11 @@ class TablePage : public Page {
 
   page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
 
+  /** @return the next page id stored in the raw data of a table page, used as the read-ahead NextPageIdFunc */
+  static page_id_t NextPageIdOf(const char *page_data) {
+    return *reinterpret_cast<const page_id_t *>(page_data + OFFSET_NEXT_PAGE_ID);
+  }
+
   void SetPrevPageId(page_id_t prev_page_id) {
     memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
   }
@@ -63,7 +68,11 @@ class TablePage : public Page {
 
   void RollbackDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
 
-  bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager);
+  /**
+   * @param column_ids the columns to read, nullptr for all of them (see Row::DeserializeFrom)
+   */
+  bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager,
+                const std::vector<uint32_t> *column_ids = nullptr);
 
   bool GetFirstTupleRid(RowId *first_rid);
 
@@ -91,6 +100,12 @@ class TablePage : public Page {
     return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
   }
 
+  /** @return the size of the largest tuple which fits in the page, a new slot is taken for it */
+  uint32_t GetFreeSpaceForTuple() {
+    uint32_t remaining = GetFreeSpaceRemaining();
+    return remaining > SIZE_TUPLE ? remaining - SIZE_TUPLE : 0;
+  }
+
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     // this function calculate actual tuple offset (slot_num is the tuple index in the slotted-page.)
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
@@ -81,6 +81,13 @@ public:
 
   uint32_t DeserializeFrom(char *buf, Schema *schema);
 
+  /**
+   * Deserialize only the columns column_ids of the tuple, the other fields are skipped without being created.
+   * @param column_ids the columns of the schema to read, in the order of the fields of the row
+   * @return the size of the whole tuple
+   */
+  uint32_t DeserializeFrom(char *buf, Schema *schema, const std::vector<uint32_t> &column_ids);
+
   /**
    * For empty row, return 0
    * For non-empty row with null fields, eg: |null|null|null|, return header size only
@@ -0,0 +1,70 @@
+#ifndef MINISQL_ROW_VIEW_H
+#define MINISQL_ROW_VIEW_H
+
+#include <vector>
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * RowView reads a tuple in place, in its serialized form on a pinned page (see Row for the format), instead of
+ * deserializing it into a Row. Nothing is decoded up front: a field is read when it is asked for, and a char field
+ * points to the bytes of the page, it is not copied. The offsets of the fields are found once per tuple, the view is
+ * reused for the next tuple without allocating.
+ *
+ * The view is valid as long as the page of the tuple stays pinned and the tuple is not updated.
+ */
+class RowView {
+ public:
+  RowView() = default;
+
+  /**
+   * Point the view to another tuple.
+   * @param data the serialized tuple
+   */
+  void Reset(const char *data, Schema *schema, RowId rid) {
+    data_ = data;
+    schema_ = schema;
+    rid_ = rid;
+    offsets_.clear();
+  }
+
+  inline RowId GetRowId() const { return rid_; }
+
+  /** @return the serialized tuple */
+  inline const char *GetData() const { return data_; }
+
+  inline uint32_t GetFieldCount() const { return MACH_READ_UINT32(data_); }
+
+  inline bool IsNull(uint32_t idx) const { return data_[sizeof(uint32_t) + idx] == '\1'; }
+
+  /**
+   * @return the field idx, a char field refers to the page and has the lifetime of the view
+   */
+  Field GetField(uint32_t idx);
+
+  /**
+   * Deserialize the tuple, for the callers which keep the row after the view moves on.
+   * @param column_ids the columns to read into row, nullptr for all of them
+   */
+  void ToRow(Row *row, const std::vector<uint32_t> *column_ids = nullptr) const {
+    if (column_ids == nullptr) {
+      row->DeserializeFrom(const_cast<char *>(data_), schema_);
+    } else {
+      row->DeserializeFrom(const_cast<char *>(data_), schema_, *column_ids);
+    }
+  }
+
+ private:
+  /** @return the offset of the field idx in the tuple */
+  uint32_t GetFieldOffset(uint32_t idx);
+
+  const char *data_{nullptr};
+  Schema *schema_{nullptr};
+  RowId rid_{};
+  std::vector<uint32_t> offsets_;  // offsets of the first fields of the tuple, found so far
+};
+
+#endif  // MINISQL_ROW_VIEW_H
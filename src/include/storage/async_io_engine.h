@@ -0,0 +1,187 @@
+#ifndef MINISQL_ASYNC_IO_ENGINE_H
+#define MINISQL_ASYNC_IO_ENGINE_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * AsyncIOEngine runs positioned reads and writes on file descriptors in the background, so that a caller can keep many
+ * I/Os in flight and wait for them together.
+ *
+ * A request is completed when all its bytes are transferred, the end of the file is reached (read), or an error
+ * occurs. Its callback is then called with the number of bytes transferred, or -errno. The callbacks run on a thread of
+ * the engine: they must be short and must not submit and wait for another request.
+ */
+class AsyncIOEngine {
+ public:
+  using Callback = std::function<void(ssize_t result)>;
+
+  virtual ~AsyncIOEngine() = default;
+
+  /**
+   * Read len bytes at offset of the file into buf, which must stay valid until the callback is called.
+   */
+  virtual void SubmitRead(int fd, char *buf, size_t len, off_t offset, Callback done) = 0;
+
+  /**
+   * Write len bytes of buf at offset of the file, buf must stay valid until the callback is called.
+   */
+  virtual void SubmitWrite(int fd, const char *buf, size_t len, off_t offset, Callback done) = 0;
+
+  /**
+   * Wait until all the submitted requests are completed.
+   */
+  virtual void Drain() = 0;
+
+  /** @return "io_uring" or "thread pool" */
+  virtual const char *GetName() const = 0;
+
+  /**
+   * Create an io_uring engine, or a thread pool engine if io_uring is not available (old kernel, disabled, or
+   * filtered by seccomp).
+   * @param queue_depth the maximum number of requests in flight, Submit waits for a free entry beyond it
+   * @param num_threads the number of threads of the thread pool engine
+   * @param use_io_uring false to create the thread pool engine directly
+   */
+  static std::unique_ptr<AsyncIOEngine> Create(size_t queue_depth, size_t num_threads, bool use_io_uring = true);
+};
+
+/**
+ * A request of an engine, one read or write.
+ */
+struct AsyncIORequest {
+  bool is_write_;
+  int fd_;
+  char *buf_;
+  size_t len_;
+  off_t offset_;
+  size_t done_{0};  // bytes transferred so far
+  struct iovec iov_;  // the remaining bytes, used by the io_uring engine
+  AsyncIOEngine::Callback callback_;
+};
+
+/**
+ * Thread pool engine: the requests are queued and served by num_threads threads with pread/pwrite.
+ */
+class ThreadPoolIOEngine : public AsyncIOEngine {
+ public:
+  ThreadPoolIOEngine(size_t queue_depth, size_t num_threads);
+
+  ~ThreadPoolIOEngine() override;
+
+  void SubmitRead(int fd, char *buf, size_t len, off_t offset, Callback done) override;
+
+  void SubmitWrite(int fd, const char *buf, size_t len, off_t offset, Callback done) override;
+
+  void Drain() override;
+
+  const char *GetName() const override { return "thread pool"; }
+
+ private:
+  void Submit(AsyncIORequest *request);
+
+  void WorkerLoop();
+
+  std::mutex latch_;
+  std::condition_variable work_cv_;  // a request is queued, or the engine stops
+  std::condition_variable idle_cv_;  // a request is completed
+  std::deque<AsyncIORequest *> queue_;
+  size_t queue_depth_;
+  size_t in_flight_{0};  // queued or being served
+  bool stopped_{false};
+  std::vector<std::thread> workers_;
+};
+
+/**
+ * io_uring engine, driven by the raw system calls: the requests are put into the submission ring and one thread reaps
+ * the completion ring. A short transfer is submitted again for the remaining bytes.
+ *
+ * A request which can not be submitted is completed at once with -errno. If the completion ring can not be waited on
+ * any more, the requests in the ring are completed with -errno and the engine hands the next requests to a thread pool
+ * engine, so that no caller waits forever.
+ */
+class IOUringEngine : public AsyncIOEngine {
+ public:
+  /**
+   * @param fallback_threads the number of threads of the thread pool engine used if the ring fails
+   * @return nullptr if io_uring can not be set up
+   */
+  static std::unique_ptr<IOUringEngine> Create(size_t queue_depth, size_t fallback_threads = 1);
+
+  ~IOUringEngine() override;
+
+  void SubmitRead(int fd, char *buf, size_t len, off_t offset, Callback done) override;
+
+  void SubmitWrite(int fd, const char *buf, size_t len, off_t offset, Callback done) override;
+
+  void Drain() override;
+
+  const char *GetName() const override { return ring_failed_ ? "thread pool" : "io_uring"; }
+
+ private:
+  IOUringEngine() = default;
+
+  bool Setup(size_t queue_depth);
+
+  void Submit(AsyncIORequest *request);
+
+  /**
+   * Put the remaining bytes of the request into the submission ring, the caller holds submit_latch_.
+   * @return 0, or the errno of the submission: the entry is taken back and the request is not in the ring
+   */
+  int PushRequest(AsyncIORequest *request);
+
+  /** put a no-op into the submission ring which wakes the completion thread up, @return false if it fails */
+  bool PushWakeUp();
+
+  /** complete the request with result and count it out of the requests in flight */
+  void Complete(AsyncIORequest *request, ssize_t result);
+
+  /**
+   * The completion ring can not be waited on: complete the requests in the ring with -error and hand the next requests
+   * to the thread pool engine. Called by the completion thread, which then stops.
+   */
+  void FailRing(int error);
+
+  void CompletionLoop();
+
+  int ring_fd_{-1};
+  unsigned sq_entries_{0};
+  // the mappings of the rings
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  // the fields of the rings
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+
+  std::mutex submit_latch_;
+  std::condition_variable idle_cv_;  // a request is completed
+  size_t in_flight_{0};              // requests submitted and not completed, protected by submit_latch_
+  std::unordered_set<AsyncIORequest *> outstanding_;  // the requests in the ring, protected by submit_latch_
+  bool stopped_{false};
+  std::thread completion_thread_;
+  size_t fallback_threads_{1};
+  std::unique_ptr<ThreadPoolIOEngine> fallback_;  // set once the ring failed, protected by submit_latch_
+  std::atomic<bool> ring_failed_{false};
+};
+
+#endif  // MINISQL_ASYNC_IO_ENGINE_H
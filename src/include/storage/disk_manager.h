@@ -3,13 +3,29 @@
 
 #include <atomic>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "storage/async_io_engine.h"
+
+/**
+ * The way the disk manager reads and writes the pages of the db file.
+ */
+enum DiskIOBackend {
+  kDiskIOStream = 0,  /** std::fstream, every page I/O holds the I/O latch for its seek and read/write */
+  kDiskIOPositioned,  /** pread/pwrite on a file descriptor, the pages are read and written concurrently */
+  kDiskIOMmapReadOnly,  /** the db file is opened read only and mapped in memory, nothing is written. The buffer pool
+                            uses the pages of the mapping in place instead of copying them into its frames, the
+                            mapping is not writable and the writes are rejected by the buffer pool. */
+};
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
@@ -21,7 +37,11 @@
  */
 class DiskManager {
 public:
-  explicit DiskManager(const std::string &db_file);
+  /**
+   * @param backend the way the pages are read and written, pread/pwrite by default. With kDiskIOPositioned the I/O
+   *                latch only protects the allocation meta data and the bitmap pages.
+   */
+  explicit DiskManager(const std::string &db_file, DiskIOBackend backend = kDiskIOPositioned);
 
   ~DiskManager() {
     if (!closed) {
@@ -41,11 +61,73 @@ public:
    */
   void WritePage(page_id_t logical_page_id, const char *page_data);
 
+  /**
+   * Read the page in the background. done is called with true once page_data holds the page, on a thread of the
+   * asynchronous I/O engine (io_uring, or a thread pool). page_data must stay valid until then.
+   * With kDiskIOStream the page is read at once, before done is called by the caller thread.
+   */
+  void ReadPageAsync(page_id_t logical_page_id, char *page_data, std::function<void(bool)> done);
+
+  /**
+   * Write the page in the background, done is called with true once it is written. page_data must stay valid and
+   * unchanged until then.
+   */
+  void WritePageAsync(page_id_t logical_page_id, const char *page_data, std::function<void(bool)> done);
+
+  /**
+   * A page written by WritePages.
+   */
+  struct PageWrite {
+    page_id_t logical_page_id_;
+    const char *page_data_;
+  };
+
+  /**
+   * Write a batch of pages in the order of the file: the pages are sorted by their place on disk, and each run of
+   * contiguous pages is written by one vectored write (pwritev). The pages are not synced, see Sync.
+   * With kDiskIOStream the pages are written one at a time in the same order.
+   * @param pages the pages to write, sorted in place
+   */
+  void WritePages(std::vector<PageWrite> *pages);
+
+  /**
+   * Make the pages written so far durable (fsync of the db file). Nothing is done if nothing was written since the
+   * last call.
+   */
+  void Sync();
+
+  /** @return a future set once the page is read */
+  std::future<bool> ReadPageAsync(page_id_t logical_page_id, char *page_data);
+
+  /** @return a future set once the page is written */
+  std::future<bool> WritePageAsync(page_id_t logical_page_id, const char *page_data);
+
+  /**
+   * Wait until all the asynchronous I/Os are completed.
+   */
+  void WaitForAsyncIO();
+
+  /** @return the name of the engine of the asynchronous I/Os, "sync" with kDiskIOStream and kDiskIOMmapReadOnly */
+  const char *GetAsyncIOEngineName();
+
+  /** @return true if the db file is opened read only (kDiskIOMmapReadOnly), the allocations and the writes fail */
+  bool IsReadOnly() const { return backend_ == kDiskIOMmapReadOnly; }
+
+  /**
+   * @return the page in the mapping of the db file, valid until Close. A change made to it stays in memory, it is
+   * never written to the file. nullptr if the file is not mapped or the page is beyond its end.
+   */
+  const char *GetMappedPage(page_id_t logical_page_id);
+
   /**
    * Get next free page from disk
+   * @param near_page_id a page of the same object (the previous page of a heap, the page split), the page after it is
+   *                     allocated if it is free, otherwise a page starting a new run of free pages of its extent. So
+   *                     the pages of an object growing one after another are mostly contiguous on disk.
+   *                     INVALID_PAGE_ID to take the first free page of the file.
    * @return logical page id of allocated page
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(page_id_t near_page_id = INVALID_PAGE_ID);
 
   /**
    * Free this page and reset bit map
@@ -57,6 +139,20 @@ public:
    */
   bool IsPageFree(page_id_t logical_page_id);
 
+  /**
+   * Set how the db file grows: the disk space is preallocated (fallocate) chunk_pages pages at a time when a page is
+   * allocated beyond the preallocated space, instead of one page at a time when a page is first written. The file
+   * size is not changed by the preallocation. 0 or 1 to let the file grow with the writes, only with
+   * kDiskIOPositioned.
+   */
+  void SetGrowthChunk(size_t chunk_pages);
+
+  /**
+   * Write the bitmap pages changed since the last call and the meta page. The allocations only change their cached
+   * copies, they are written by Close and by the checkpoints of the buffer pool (FlushAllPages).
+   */
+  void FlushMetaData();
+
   /**
    * Shut down the disk manager and close all the file resources.
    */
@@ -88,21 +184,73 @@ private:
    */
   void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
 
+  /**
+   * Write the contiguous physical pages starting at first_physical_page_id, one page per iovec (kDiskIOPositioned).
+   */
+  void WritePhysicalPages(page_id_t first_physical_page_id, struct iovec *iov, int iovcnt);
+
+  /**
+   * @return the asynchronous I/O engine, created at the first use. nullptr with kDiskIOStream.
+   */
+  AsyncIOEngine *GetAsyncIOEngine();
+
   /**
    * Map logical page id to physical page id
    */
   page_id_t MapPageId(page_id_t logical_page_id);
 
+  /**
+   * Preallocate the disk space of the file up to the physical page, a chunk at a time. The caller holds db_io_latch_.
+   */
+  void GrowFile(page_id_t physical_page_id);
+
+  /**
+   * Count the page just allocated in the bitmap of the extent. The caller holds db_io_latch_.
+   * @return its logical page id
+   */
+  page_id_t OnPageAllocated(uint32_t extent_id, uint32_t page_offset);
+
+  /**
+   * @return the cached bitmap page of the extent, read from the disk at the first use. The caller holds db_io_latch_.
+   */
+  BitmapPage<PAGE_SIZE> *GetBitmap(uint32_t extent_id);
+
+  /**
+   * Find the first extent which is not full. A db file whose meta page was never written gets its meta page rebuilt
+   * from the bitmap pages.
+   */
+  void LoadMetaData();
+
   
 
 private:
   // stream to write db file
   std::fstream db_io_;
+  // file descriptor of the db file, used by kDiskIOPositioned and kDiskIOMmapReadOnly
+  int db_fd_{-1};
+  // the disk space is preallocated growth_chunk_pages_ pages at a time, up to preallocated_pages_
+  size_t growth_chunk_pages_{FILE_GROWTH_CHUNK_PAGES};
+  size_t preallocated_pages_{0};
+  // the mapping of the whole db file with kDiskIOMmapReadOnly
+  char *mapping_{nullptr};
+  size_t mapping_size_{0};
+  DiskIOBackend backend_;
+  std::unique_ptr<AsyncIOEngine> async_io_engine_;
+  std::once_flag async_io_engine_once_;
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect  access
+  // with multiple buffer pool instances, need to protect  access. With kDiskIOPositioned, only the allocation.
   std::recursive_mutex db_io_latch_;
   bool closed{false};
   char meta_data_[PAGE_SIZE];
+  bool meta_dirty_{false};
+  // a page was written since the last Sync
+  std::atomic<bool> unsynced_{false};
+  // cached bitmap pages by extent id, their summaries, and whether they changed since they were written
+  std::vector<std::unique_ptr<BitmapPage<PAGE_SIZE>>> bitmaps_;
+  std::vector<BitmapPage<PAGE_SIZE>::Summary> bitmap_summaries_;
+  std::vector<bool> bitmap_dirty_;
+  // all the extents before it are full, the next page is allocated from it
+  uint32_t first_free_extent_{0};
   /**
    * ReadBitMapPage
    */
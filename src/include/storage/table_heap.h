@@ -2,6 +2,7 @@
 #define MINISQL_TABLE_HEAP_H
 
 #include "buffer/buffer_pool_manager.h"
+#include "page/free_space_map_page.h"
 #include "page/table_page.h"
 #include "storage/table_iterator.h"
 #include "transaction/lock_manager.h"
@@ -17,27 +18,46 @@ class TableHeap {
     return new (buf) TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
   }
 
+  /**
+   * @param free_space_map_page_id the root of the free space map of the heap, INVALID_PAGE_ID if the heap has none
+   *        (created before the free space map): the inserts then try the pages of the heap one after another
+   */
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap) {
+                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap,
+                           page_id_t free_space_map_page_id = INVALID_PAGE_ID) {
     void *buf = heap->Allocate(sizeof(TableHeap));
-    return new (buf) TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+    return new (buf)
+        TableHeap(buffer_pool_manager, first_page_id, free_space_map_page_id, schema, log_manager, lock_manager);
   }
 
   ~TableHeap() {}
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table. If the tuple is too large (>= page_size) or the db file is read only, return false.
+   * The tuple goes to the first page with enough room according to the free space map, or to a new page appended to
+   * the heap.
    * @param[in/out] row Tuple Row to insert, the rid of the inserted tuple is wrapped in object row
    * @param[in] txn The transaction performing the insert
    * @return true iff the insert is successful
    */
   bool InsertTuple(Row &row, Transaction *txn);
 
+  /**
+   * Insert a batch of tuples into the table. A page with room is latched once and filled with as many tuples as fit,
+   * in the order of the batch, and the pages needed once the free space map has no room left are appended one after
+   * another, without searching the map again.
+   * @param[in/out] rows Tuple Rows to insert, the rid of every inserted tuple is wrapped in its row
+   * @param[in] txn The transaction performing the insert
+   * @return true iff all the tuples are inserted, nothing is inserted if one of them is too large or if the db file is
+   *         read only
+   */
+  bool InsertTuples(std::vector<Row> &rows, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
    * @param[in] txn Transaction performing the delete
-   * @return true iff the delete is successful (i.e the tuple exists)
+   * @return true iff the delete is successful (i.e the tuple exists and the db file is not read only)
    */
   bool MarkDelete(const RowId &rid, Transaction *txn);
 
@@ -46,7 +66,7 @@ class TableHeap {
    * @param[in] row Tuple of new row
    * @param[in] rid Rid of the old tuple
    * @param[in] txn Transaction performing the update
-   * @return true is update is successful.
+   * @return true is update is successful, false if the db file is read only.
    */
   bool UpdateTuple(Row &row, const RowId &rid, Transaction *txn);
 
@@ -68,19 +88,23 @@ class TableHeap {
    * Read a tuple from the table.
    * @param[in/out] row Output variable for the tuple, row id of the tuple is wrapped in row
    * @param[in] txn transaction performing the read
+   * @param[in] column_ids the columns to read into row, in this order, nullptr for all the columns of the table
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(Row *row, Transaction *txn);
+  bool GetTuple(Row *row, Transaction *txn, const std::vector<uint32_t> *column_ids = nullptr);
 
   /**
    * Free table heap and release storage in disk file
+   * No page of the heap may be pinned: every TableIterator of the heap must be destroyed before.
    */
   void FreeHeap();
 
   /**
+   * @param strategy access strategy of a large scan, the pages are read through its ring of frames so that the scan
+   *        does not evict the working set of the buffer pool. nullptr to read them as usual.
    * @return the begin iterator of this table
    */
-  TableIterator Begin(Transaction *txn);
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * @return the end iterator of this table
@@ -92,6 +116,11 @@ class TableHeap {
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @return the id of the root page of the free space map of this table, INVALID_PAGE_ID if it has none
+   */
+  inline page_id_t GetFreeSpaceMapPageId() const { return free_space_map_page_id_; }
+
  private:
   /**
    * create table heap and initialize first page
@@ -102,32 +131,59 @@ class TableHeap {
         schema_(schema),
         log_manager_(log_manager),
         lock_manager_(lock_manager) {
+    // the root of the free space map is allocated first, so that the pages of the heap can follow the first one.
+    BasicPageGuard root_guard = buffer_pool_manager->NewPageGuarded(free_space_map_page_id_);
     // Due to Page0 and Page1 stored Catalog and Index.
     // We need to Start at Page2
-    page_id_t newpage;
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->NewPage(newpage));
-    this->first_page_id_ = page->GetPageId();
-    page->Init(page->GetPageId(), INVALID_PAGE_ID, log_manager, txn);
+    BasicPageGuard guard = buffer_pool_manager->NewPageGuarded(first_page_id_);
+    reinterpret_cast<TablePage *>(guard.GetPage())->Init(first_page_id_, INVALID_PAGE_ID, log_manager, txn);
     // Flush First Page
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    guard.SetDirty();
+    root_guard.AsMut<FreeSpaceMapRootPage>()->Init(first_page_id_);
+    root_guard.Drop();
+    RecordFreeSpace(reinterpret_cast<TablePage *>(guard.GetPage()));
   };
 
   /**
    * load existing table heap by first_page_id
    */
-  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, page_id_t free_space_map_page_id,
+                     Schema *schema, LogManager *log_manager, LockManager *lock_manager)
       : buffer_pool_manager_(buffer_pool_manager),
         first_page_id_(first_page_id),
+        free_space_map_page_id_(free_space_map_page_id),
         schema_(schema),
         log_manager_(log_manager),
         lock_manager_(lock_manager) {}
   page_id_t AllocateNewPage(page_id_t last_page_id, BufferPoolManager *buffer_pool_manager_, Transaction *txn,
                             LockManager *lock_manager, LogManager *log_manager);
 
+  /**
+   * Insert a tuple into a heap without free space map, the pages are tried from the first one.
+   */
+  bool InsertTupleLinear(Row &row, Transaction *txn);
+
+  /**
+   * @return a page of the heap with room for a tuple of tuple_size bytes according to the free space map, or the last
+   *         page of the heap if it is past the pages the map records and has the room, INVALID_PAGE_ID if there is none
+   */
+  page_id_t FindPageWithSpace(uint32_t tuple_size);
+
+  /**
+   * Allocate a page, link it after the last page of the heap and record it in the free space map.
+   * @return the id of the new page, INVALID_PAGE_ID if no page can be allocated
+   */
+  page_id_t AppendPage(Transaction *txn);
+
+  /**
+   * Record the room left on a page of the heap in the free space map. The caller holds the write latch of the page.
+   */
+  void RecordFreeSpace(TablePage *page);
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
+  page_id_t free_space_map_page_id_{INVALID_PAGE_ID};
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
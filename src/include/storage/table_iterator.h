@@ -5,6 +5,7 @@
 #include "common/rowid.h"
 #include "page/table_page.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "transaction/transaction.h"
 
 class TableHeap;
@@ -12,23 +13,26 @@ class TableHeap;
 class TableIterator {
  public:
   // you may define your own constructor based on your member variables
+  /**
+   * @param page_guard the pin of the current table page, held as long as the iterator is on this page
+   */
   explicit TableIterator(RowId rowId_, char *Position, BufferPoolManager *buffer_pool_manager_, Schema *schema,
-                         TablePage *table_page)
-      : heap_(new SimpleMemHeap) {
+                         BasicPageGuard &&page_guard, BufferAccessStrategy *strategy = nullptr)
+      : page_guard_(std::move(page_guard)) {
     this->rowId_ = rowId_;
     this->Position = Position;
     this->buffer_pool_manager_ = buffer_pool_manager_;
-    this->Page_pointer = table_page;
+    this->Page_pointer = reinterpret_cast<TablePage *>(page_guard_.GetPage());
     this->schema = schema;
+    this->strategy_ = strategy;
   }
 
-  explicit TableIterator(const TableIterator &other) : heap_(new SimpleMemHeap) {
-    this->rowId_ = other.rowId_;
-    this->Position = other.Position;
-    this->buffer_pool_manager_ = other.buffer_pool_manager_;
-    this->Page_pointer = other.Page_pointer;
-    this->schema = other.schema;
-  }
+  /**
+   * The copy pins the current page again, it stays valid after the other iterator moves on.
+   */
+  explicit TableIterator(const TableIterator &other);
+
+  TableIterator(TableIterator &&other) = default;
 
   virtual ~TableIterator();
 
@@ -36,10 +40,20 @@ class TableIterator {
 
   bool operator!=(const TableIterator &itr) const;
 
+  /**
+   * The row is deserialized once per tuple and freed when the iterator moves on.
+   */
   const Row &operator*();
 
   Row *operator->();
 
+  /**
+   * Read the current tuple in place, without deserializing it into a Row: the predicates of a scan decode only the
+   * fields they compare, and nothing is allocated per tuple.
+   * @return the view of the current tuple, valid until the iterator moves on
+   */
+  RowView &View();
+
   TableIterator &operator++();  // ++i
 
   TableIterator operator++(int);  // i++
@@ -51,12 +65,20 @@ class TableIterator {
   // Current Position of the Page
   char *Position;
 
-  // Current table page, need to access the table page of the caller.
+  // Current table page, need to access the table page of the caller. Pinned by page_guard_, nullptr at the end.
   TablePage *Page_pointer;
+  BasicPageGuard page_guard_;
 
   BufferPoolManager *buffer_pool_manager_;
   Schema *schema;
-  MemHeap *heap_ = {nullptr};
+  // the current tuple, read in place by View() and deserialized by operator* on demand
+  RowView view_;
+  bool view_valid_ = {false};
+  std::unique_ptr<Row> row_;
+  // the ring of frames of a large scan, nullptr if the pages are read through the buffer pool as usual.
+  BufferAccessStrategy *strategy_ = {nullptr};
+  // the pages of the last read-ahead window not reached by the scan yet, TableHeap::Begin requests the first window.
+  int read_ahead_left_ = {TABLE_READ_AHEAD_PAGES};
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
@@ -13,13 +13,11 @@ BPLUSTREE_TYPE::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_ma
           comparator_(comparator),
           leaf_max_size_(leaf_max_size),
           internal_max_size_(internal_max_size) {
-  IndexRootsPage *idx_roots_page =
-      reinterpret_cast<IndexRootsPage *>(buffer_pool_manager->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
-  bool ret = idx_roots_page->GetRootId(index_id_, &root_page_id_);
+  BasicPageGuard guard = buffer_pool_manager->FetchPageBasic(INDEX_ROOTS_PAGE_ID);
+  bool ret = guard.As<IndexRootsPage>()->GetRootId(index_id_, &root_page_id_);
   if (ret == false) {
     root_page_id_ = INVALID_PAGE_ID;
   }
-  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -101,22 +99,18 @@ bool BPLUSTREE_TYPE::IsEmpty() const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction) {
-  bool state = false;
-  auto page = this->FindLeafPage(key, false);
-  auto* leaf = reinterpret_cast<LeafPage *> (page->GetData());
+  BasicPageGuard guard = this->FindLeafPageGuarded(key, false);
+  if (!guard) {
+    // the tree is empty
+    return false;
+  }
   ValueType tmp;
-  if (leaf->Lookup(key,tmp,this->comparator_) == true) {
-      //key is exist in the LeafPage
-    result.push_back(tmp);
-    state = true;
-   } 
-  else 
-  {
-    //Key is exist or not
-    state = false;
-   }
-   buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-   return state;
+  if (guard.As<LeafPage>()->Lookup(key, tmp, this->comparator_) == false) {
+    //Key is not exist in the LeafPage
+    return false;
+  }
+  result.push_back(tmp);
+  return true;
 }
 
 
@@ -154,9 +148,9 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
     page_id_t NewId = INVALID_PAGE_ID;
     //Get the New Root
-    Page *page = buffer_pool_manager_->NewPage(NewId);
-    if (page != nullptr) {
-      auto *node = reinterpret_cast<LeafPage *>(page->GetData());
+    BasicPageGuard guard = buffer_pool_manager_->NewPageGuarded(NewId);
+    if (guard) {
+      auto *node = guard.AsMut<LeafPage>();
       //Init Leaf Root
       node->Init(NewId, INVALID_PAGE_ID, this->leaf_max_size_);
       //Insert First Tuple
@@ -164,9 +158,7 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
       //Set the Root Page to the NewId
       this->root_page_id_ = NewId;
       this->UpdateRootPageId(true);
-      buffer_pool_manager_->UnpinPage(NewId,true);
     } else {
-      buffer_pool_manager_->UnpinPage(NewId, false);
       std::cerr << "out of memory" << endl;
     }
 
@@ -182,64 +174,30 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-   
-    //1. Find the Leaf Node for the key
-  bool state = false;
-   //std::cout << "InsertIntoLeaf::FindLeafPage()" << endl;
-  auto page = FindLeafPage(key, false);
-   //std::cout << "InsertIntoLeaf::After FindLeafPage()" << endl;
-  auto*  leaf = reinterpret_cast<LeafPage *> (page->GetData());
+  //1. Find the Leaf Node for the key
+  BasicPageGuard guard = FindLeafPageGuarded(key, false);
+  if (!guard) {
+    std::cerr << "out of memory" << endl;
+    return false;
+  }
+  auto *leaf = guard.As<LeafPage>();
   ValueType tmp;
   //2.Find the key exists in the Leaf Node or not
-  if (page!=nullptr&&leaf->Lookup(key,tmp,comparator_)==true) {
-    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+  if (leaf->Lookup(key, tmp, comparator_) == true) {
     std::cerr << "BPLUSTREE_TYPE::InsertIntoLeaf-----It already Has key" << endl;
-    return state;
-  } else {
-    
-    if (leaf != nullptr) {
-    
-      int size = leaf->Insert(key,value,this->comparator_);
-      /*for (int i = 0; i < leaf->GetSize(); i++) cout << leaf->array_[i].first << " ";
-      cout << endl;*/
-      if (size >= this->leaf_max_size_) {
-         //If the Leaf Node is OverFlow
-         //Split LeafNode
-     
-        auto *NewNode = this->Split(leaf);
-       
-        //auto *Leaf = reinterpret_cast<LeafPage *>(NewNode);
-        //this->ToString(leaf, buffer_pool_manager_);
-        //this->ToString(Leaf,buffer_pool_manager_);
-        KeyType NewKey = NewNode->KeyAt(0);
-        
-        //Insert NewKey into the ParentNode
-        //std::cout << "InsertIntoLeaf::InsertIntoParent()" << endl;
-        this->InsertIntoParent(leaf,NewKey,NewNode,transaction);
-        
-        //std::cout << "InsertIntoLeaf::AfterInsertIntoParent()" << endl;
-        state = true;
-      } else {
-          //If the Leaf Node is  not OverFlow
-       
-        //this->ToString(leaf, buffer_pool_manager_);
-          state = true;
-          
-      }
-      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
-     
-      
-    } else {
-      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-      std::cerr << "out of memory" << endl;
-      state = false;
-    }
+    return false;
   }
-  return state;
+  guard.SetDirty();
+  int size = leaf->Insert(key, value, this->comparator_);
+  if (size >= this->leaf_max_size_) {
+    //If the Leaf Node is OverFlow, Split LeafNode and Insert NewKey into the ParentNode
+    auto *NewNode = this->Split(leaf);
+    KeyType NewKey = NewNode->KeyAt(0);
+    this->InsertIntoParent(leaf, NewKey, NewNode, transaction);
+  }
+  return true;
 }
 
-
-//ʲôpageͶSplitInternalPageSize---δ
 /*
  * Split input page and return newly created page.
  * Using template N to represent either internal page or leaf page.
@@ -251,7 +209,8 @@ INDEX_TEMPLATE_ARGUMENTS
 template<typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
      page_id_t NewId = INVALID_PAGE_ID;
-     auto *page = buffer_pool_manager_->NewPage(NewId);
+     // the new right sibling is allocated after the node on disk, the leaf chain stays mostly sequential.
+     auto *page = buffer_pool_manager_->NewPageNear(NewId, node->GetPageId());
      if (page != nullptr) {
        N *NewNode = reinterpret_cast<N *>(page->GetData());
        //Init 
@@ -760,29 +719,13 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { 
-   KeyType key;    
-  auto page = this->FindLeafPage(key, true);
-
-  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
-  page_id_t CurrPageId = leaf->GetPageId();
-
- 
-  bool state = false;
-
-  // First Page Has Tuple
-  if (leaf->GetSize() == 0)
-    state = false;
-  else
-    state = true;
-
-  if (state == false) {
-    buffer_pool_manager_->UnpinPage(CurrPageId, false);
+  KeyType key;
+  BasicPageGuard guard = this->FindLeafPageGuarded(key, true);
+  // the tree is empty, or the First Page Has no Tuple
+  if (!guard || guard.As<LeafPage>()->GetSize() == 0) {
     return INDEXITERATOR_TYPE(INVALID_PAGE_ID, 0, buffer_pool_manager_);
-  } else {
-    buffer_pool_manager_->UnpinPage(CurrPageId, false);
-    int index = 0;
-    return INDEXITERATOR_TYPE(CurrPageId, index, buffer_pool_manager_);
   }
+  return INDEXITERATOR_TYPE(guard.GetPageId(), 0, buffer_pool_manager_);
 }
 
 /*
@@ -792,23 +735,17 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  auto page = this->FindLeafPage(key, false);
-
-  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
-  page_id_t CurrPageId = leaf->GetPageId();
-
+  BasicPageGuard guard = this->FindLeafPageGuarded(key, false);
+  if (!guard) {
+    return INDEXITERATOR_TYPE(INVALID_PAGE_ID, 0, buffer_pool_manager_);
+  }
+  auto *leaf = guard.As<LeafPage>();
   ValueType value;
-  bool state=leaf->Lookup(key, value, this->comparator_);
   // if the key is not exists in the LeafPage
-  if (state == false) {
-    buffer_pool_manager_->UnpinPage(CurrPageId, false);
+  if (leaf->Lookup(key, value, this->comparator_) == false) {
     return INDEXITERATOR_TYPE(INVALID_PAGE_ID, 0, buffer_pool_manager_);
-  } else {
-    buffer_pool_manager_->UnpinPage(CurrPageId, false);
-    int index = leaf->ValueIndex(value);
-    return INDEXITERATOR_TYPE(CurrPageId, index, buffer_pool_manager_);  
   }
-  
+  return INDEXITERATOR_TYPE(guard.GetPageId(), leaf->ValueIndex(value), buffer_pool_manager_);
 }
 
 /*
@@ -842,40 +779,26 @@ void BPLUSTREE_TYPE::TrackPage2(page_id_t root_page_id_, BufferPoolManager *buff
  * Note: the leaf page is pinned, you need to unpin it after use.
  */
 INDEX_TEMPLATE_ARGUMENTS
-Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) { 
-    Page *ptr = nullptr;
-    if (this->IsEmpty()) return ptr;
-    else {
-        //Get the Root Page
-      auto page = buffer_pool_manager_->FetchPage(this->root_page_id_);
-      auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
-      //std::cout << "FindLeafPage--- The Root Page is" << node->GetPageId() << endl;
-      // if the root node is leaf page
-      if (node->IsLeafPage()) {
-        ptr= page;
-      
-      } else {
-      // if the root node is not leaf page
-        page_id_t NextPage;
-        while (node->IsLeafPage() == false) {
-          InternalPage * InternalNode = reinterpret_cast<InternalPage *>(page->GetData());
-          if (leftMost != true) {
-            NextPage = InternalNode->Lookup(key, comparator_);
-          }
-          else {
-              // Get the Left Most Item
-            NextPage = InternalNode->ValueAt(0);
-          }
-          buffer_pool_manager_->UnpinPage(node->GetPageId(),false);
-          //Get Next Page
-          page = buffer_pool_manager_->FetchPage(NextPage);
-          node = reinterpret_cast<BPlusTreePage *>(page->GetData());  
-        }
-        ptr= page;
-      }
-    }
-  
-    return ptr;
+Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
+  return FindLeafPageGuarded(key, leftMost).Release();
+}
+
+/*
+ * Same as FindLeafPage, the leaf page is unpinned by the returned guard. Each
+ * page on the way down is unpinned once its child is pinned.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+BasicPageGuard BPLUSTREE_TYPE::FindLeafPageGuarded(const KeyType &key, bool leftMost) {
+  if (this->IsEmpty()) return BasicPageGuard();
+  //Get the Root Page
+  BasicPageGuard guard = buffer_pool_manager_->FetchPageBasic(this->root_page_id_);
+  while (guard && guard.As<BPlusTreePage>()->IsLeafPage() == false) {
+    InternalPage *InternalNode = guard.As<InternalPage>();
+    // Get the Left Most Item, or the child which may hold the key
+    page_id_t NextPage = leftMost ? InternalNode->ValueAt(0) : InternalNode->Lookup(key, comparator_);
+    guard = buffer_pool_manager_->FetchPageBasic(NextPage);
+  }
+  return guard;
 }
 
 
@@ -889,18 +812,16 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(bool state) { 
-  auto page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID); 
-  auto IndexPage = reinterpret_cast<IndexRootsPage *>(page->GetData());
+  BasicPageGuard guard = buffer_pool_manager_->FetchPageBasic(INDEX_ROOTS_PAGE_ID);
+  auto IndexPage = guard.AsMut<IndexRootsPage>();
 
   if (this->root_page_id_ == INVALID_PAGE_ID) {
     IndexPage->Delete(this->index_id_);
-    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
     return;
   }
 
   if(state==true) IndexPage->Insert(this->index_id_, this->root_page_id_);
   else IndexPage->Update(this->index_id_, this->root_page_id_);
-  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);   
 }
 
 /**
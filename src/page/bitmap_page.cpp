@@ -1,81 +1,134 @@
 #include "page/bitmap_page.h"
-#include<iostream>
-using namespace std;
+
 template<size_t PageSize>
-bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
-  bool state=false;
-  
-  //Bitmap is not FUll
-  if(page_allocated_<GetMaxSupportedSize())
-  {
-    //Update page_allocatted
-    this->page_allocated_++;
-    //page_offset is next_free_page
-    //if the next_free_page is not deleted before
-    
-    while(IsPageFree(this->next_free_page_)==false&&this->next_free_page_<GetMaxSupportedSize())
-    {
-      this->next_free_page_++;
-      //flag=1;
+bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset, Summary *summary) {
+  //BitMap is Full
+  if (page_allocated_ >= GetMaxSupportedSize()) {
+    return false;
+  }
+  // no page before next_free_page_ is free, the search starts from it.
+  uint32_t page = FindFreePage(next_free_page_, summary);
+  if (page >= GetMaxSupportedSize()) {
+    // next_free_page_ of a page written by an older version may be behind a free page.
+    page = FindFreePage(0, summary);
+    if (page >= GetMaxSupportedSize()) {
+      return false;
     }
-    page_offset=this->next_free_page_;
-    //Get the Byte_index and bit_index of the Allocate Page
-    uint32_t byte_index=this->next_free_page_/8;
-    uint32_t bit_index=this->next_free_page_%8;
-    //Update BitMap 
-    unsigned char tmp=0x01;
-    bytes[byte_index]=(bytes[byte_index]|(tmp<<(7-bit_index)));
-    //Update next_free_page
-    while(IsPageFree(this->next_free_page_)==false&&this->next_free_page_<GetMaxSupportedSize()){this->next_free_page_++;}
-    state=true;
-    //std::cout<<"next_free_page-----------"<<next_free_page_<<endl;
+  }
+  page_offset = page;
+  SetAllocated(page, summary);
+  // the pages before it are all allocated now, the next search starts after it.
+  next_free_page_ = page + 1;
+  return true;
+}
 
+template<size_t PageSize>
+bool BitmapPage<PageSize>::AllocatePageNear(uint32_t goal, uint32_t &page_offset, Summary *summary) {
+  if (goal >= GetMaxSupportedSize() || page_allocated_ >= GetMaxSupportedSize()) {
+    return false;
   }
-  else{
-  //BitMap is Full
-    //std::cout<<"Can not Allocate Page Anymore"<<std::endl;
-    state=false;
+  if (IsPageFree(goal)) {
+    page_offset = goal;
+    SetAllocated(goal, summary);
+    return true;
+  }
+  // start a new run where no other page is allocated yet
+  for (size_t word_index = goal / 64 + 1; word_index < NUM_WORDS; word_index++) {
+    if (LoadWord(word_index) == 0) {
+      page_offset = word_index * 64;
+      SetAllocated(page_offset, summary);
+      return true;
+    }
+  }
+  return false;
+}
+
+template<size_t PageSize>
+bool BitmapPage<PageSize>::DeAllocatePage(uint32_t page_offset, Summary *summary) {
+  if (page_offset >= GetMaxSupportedSize() || page_allocated_ == 0 || IsPageFree(page_offset)) {
+    return false;
+  }
+  uint32_t byte_index = page_offset / 8;
+  uint32_t bit_index = page_offset % 8;
+  bytes[byte_index] &= static_cast<unsigned char>(~(0x80 >> bit_index));
+  page_allocated_--;
+  if (page_offset < next_free_page_) {
+    next_free_page_ = page_offset;
+  }
+  if (summary != nullptr) {
+    summary->words_[page_offset / 64 / 64] |= 1ULL << (page_offset / 64 % 64);
   }
-  return state;
+  return true;
 }
 
 template<size_t PageSize>
-bool BitmapPage<PageSize>::DeAllocatePage(uint32_t page_offset) {
-  //Get the Byte_index and bit_index
-  uint32_t byte_index=page_offset/8;
-  uint32_t bit_index=page_offset%8;
-  bool state=false;
-  if(this->page_allocated_==0||IsPageFree(page_offset)==true)
-  {
-    
-    //std::cout<<"Allocate First"<<std::endl;
-    state= false;
+void BitmapPage<PageSize>::SetAllocated(uint32_t page_offset, Summary *summary) {
+  uint32_t byte_index = page_offset / 8;
+  uint32_t bit_index = page_offset % 8;
+  bytes[byte_index] |= static_cast<unsigned char>(0x80 >> bit_index);
+  page_allocated_++;
+  // no page before next_free_page_ is free, if it was the page the next search starts after it.
+  if (page_offset == next_free_page_) {
+    next_free_page_ = page_offset + 1;
   }
-  else 
-  {
-    unsigned char tmp=0x01;
-    tmp=~(tmp<<(7-bit_index));
-    bytes[byte_index]=bytes[byte_index]&tmp;
-    this->page_allocated_--;
-    if(page_offset<this->next_free_page_)this->next_free_page_=page_offset;
-    state=true;
+  if (summary != nullptr && LoadWord(page_offset / 64) == ~0ULL) {
+    summary->words_[page_offset / 64 / 64] &= ~(1ULL << (page_offset / 64 % 64));
   }
-  return state;
 }
 
 template<size_t PageSize>
 bool BitmapPage<PageSize>::IsPageFree(uint32_t page_offset) const {
-  uint32_t byte_index=page_offset/8;
-  uint32_t bit_index=page_offset%8;
-  unsigned char tmp=0x01;
-  unsigned char PageState=(bytes[byte_index]&(tmp<<(7-bit_index)));
-  if(PageState==0) return true;
-  else return false;
+  return IsPageFreeLow(page_offset / 8, page_offset % 8);
 }
 
 template<size_t PageSize>
 bool BitmapPage<PageSize>::IsPageFreeLow(uint32_t byte_index, uint8_t bit_index) const {
-  return false;
+  return (bytes[byte_index] & (0x80 >> bit_index)) == 0;
+}
+
+template<size_t PageSize>
+void BitmapPage<PageSize>::BuildSummary(Summary *summary) const {
+  memset(summary->words_, 0, sizeof(summary->words_));
+  for (size_t i = 0; i < NUM_WORDS; i++) {
+    if (LoadWord(i) != ~0ULL) {
+      summary->words_[i / 64] |= 1ULL << (i % 64);
+    }
+  }
+}
+
+template<size_t PageSize>
+uint32_t BitmapPage<PageSize>::FindFreePage(uint32_t from, const Summary *summary) const {
+  size_t word_index = from / 64;
+  if (word_index >= NUM_WORDS) {
+    return GetMaxSupportedSize();
+  }
+  // the free pages of the first word, from the page from on
+  uint64_t free_bits = ~LoadWord(word_index) & (~0ULL >> (from % 64));
+  if (free_bits != 0) {
+    return word_index * 64 + __builtin_clzll(free_bits);
+  }
+  word_index++;
+  if (summary != nullptr) {
+    // the first word with a free page, found from the summary
+    for (size_t i = word_index / 64; i < (NUM_WORDS + 63) / 64; i++) {
+      uint64_t words = summary->words_[i];
+      if (i == word_index / 64) {
+        words &= ~0ULL << (word_index % 64);
+      }
+      if (words != 0) {
+        size_t free_word = i * 64 + __builtin_ctzll(words);
+        return free_word * 64 + __builtin_clzll(~LoadWord(free_word));
+      }
+    }
+    return GetMaxSupportedSize();
+  }
+  for (; word_index < NUM_WORDS; word_index++) {
+    free_bits = ~LoadWord(word_index);
+    if (free_bits != 0) {
+      return word_index * 64 + __builtin_clzll(free_bits);
+    }
+  }
+  return GetMaxSupportedSize();
 }
 
 template
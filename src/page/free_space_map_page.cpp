@@ -0,0 +1,35 @@
+#include "page/free_space_map_page.h"
+
+void FreeSpaceMapRootPage::Init(page_id_t last_page_id) {
+  last_page_id_ = last_page_id;
+  for (uint32_t i = 0; i < MAX_LEAVES; i++) {
+    leaf_page_ids_[i] = INVALID_PAGE_ID;
+  }
+  memset(leaf_max_, 0, sizeof(leaf_max_));
+}
+
+uint32_t FreeSpaceMapRootPage::FindLeaf(uint8_t category, uint32_t from) const {
+  for (uint32_t i = from; i < MAX_LEAVES; i++) {
+    if (leaf_max_[i] >= category) {
+      return i;
+    }
+  }
+  return MAX_LEAVES;
+}
+
+uint32_t FreeSpaceMapLeafPage::FindPage(uint8_t category) const {
+  for (uint32_t i = 0; i < LEAF_PAGES; i++) {
+    if (categories_[i] >= category) {
+      return i;
+    }
+  }
+  return LEAF_PAGES;
+}
+
+uint8_t FreeSpaceMapLeafPage::GetMaxCategory() const {
+  uint8_t max_category = 0;
+  for (uint32_t i = 0; i < LEAF_PAGES; i++) {
+    max_category = categories_[i] > max_category ? categories_[i] : max_category;
+  }
+  return max_category;
+}
@@ -57,7 +57,7 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
   ofs += FieldNum;
   
   //   3.Get the Field
-  std::vector<Column *> Column = schema->GetColumns(); 
+  const std::vector<Column *> &Column = schema->GetColumns();
   for (uint32_t i = 0; i < FieldNum; i++) {
     if (NullBitMap[i] == '\1') {
       //it means that this field is null
@@ -75,6 +75,33 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
   return ofs;
 }
 
+uint32_t Row::DeserializeFrom(char *buf, Schema *schema, const std::vector<uint32_t> &column_ids) {
+  if (buf == nullptr) return 0;
+  uint32_t FieldNum = MACH_READ_FROM(uint32_t, (buf));
+  ASSERT(FieldNum == schema->GetColumnCount(), "Field Count does not match");
+  const char *NullBitMap = buf + sizeof(uint32_t);
+  uint32_t ofs = sizeof(uint32_t) + FieldNum;
+  const std::vector<Column *> &Column = schema->GetColumns();
+  // walk the fields once, a field is created at every position of the projection which asks for it.
+  this->fields_.assign(column_ids.size(), nullptr);
+  for (uint32_t i = 0; i < FieldNum; i++) {
+    bool is_null = NullBitMap[i] == '\1';
+    uint32_t size = 0;
+    for (uint32_t j = 0; j < column_ids.size(); j++) {
+      if (column_ids[j] == i) {
+        size = Field::DeserializeFrom(buf + ofs, Column[i]->GetType(), &this->fields_[j], is_null, heap_);
+      }
+    }
+    if (!is_null && size == 0) {
+      // not projected, skip it
+      TypeId type = Column[i]->GetType();
+      size = type == TypeId::kTypeChar ? sizeof(uint32_t) + MACH_READ_UINT32(buf + ofs) : Type::GetTypeSize(type);
+    }
+    ofs += size;
+  }
+  return ofs;
+}
+
 uint32_t Row::GetSerializedSize(Schema *schema) const {
   //1.Calculate the FieldNumber
   uint32_t ofs = 0;
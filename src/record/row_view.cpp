@@ -0,0 +1,34 @@
+#include "record/row_view.h"
+
+Field RowView::GetField(uint32_t idx) {
+  ASSERT(idx < GetFieldCount(), "Failed to access field");
+  TypeId type = schema_->GetColumn(idx)->GetType();
+  if (IsNull(idx)) {
+    return Field(type);
+  }
+  const char *buf = data_ + GetFieldOffset(idx);
+  if (type == TypeId::kTypeInt) {
+    return Field(type, MACH_READ_FROM(int32_t, buf));
+  } else if (type == TypeId::kTypeFloat) {
+    return Field(type, MACH_READ_FROM(float, buf));
+  }
+  return Field(type, const_cast<char *>(buf) + sizeof(uint32_t), MACH_READ_UINT32(buf), false);
+}
+
+uint32_t RowView::GetFieldOffset(uint32_t idx) {
+  if (offsets_.empty()) {
+    // the first field follows the header
+    offsets_.push_back(sizeof(uint32_t) + GetFieldCount());
+  }
+  // skip the fields between the last offset found and idx, a null field takes no byte
+  while (offsets_.size() <= idx) {
+    uint32_t prev = offsets_.size() - 1;
+    uint32_t ofs = offsets_.back();
+    if (!IsNull(prev)) {
+      TypeId type = schema_->GetColumn(prev)->GetType();
+      ofs += type == TypeId::kTypeChar ? sizeof(uint32_t) + MACH_READ_UINT32(data_ + ofs) : Type::GetTypeSize(type);
+    }
+    offsets_.push_back(ofs);
+  }
+  return offsets_[idx];
+}
@@ -0,0 +1,380 @@
+#include "storage/async_io_engine.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "glog/logging.h"
+
+std::unique_ptr<AsyncIOEngine> AsyncIOEngine::Create(size_t queue_depth, size_t num_threads, bool use_io_uring) {
+  if (use_io_uring) {
+    std::unique_ptr<IOUringEngine> engine = IOUringEngine::Create(queue_depth, num_threads);
+    if (engine != nullptr) {
+      return engine;
+    }
+    LOG(INFO) << "io_uring is not available, the asynchronous I/O is done by a thread pool" << std::endl;
+  }
+  return std::make_unique<ThreadPoolIOEngine>(queue_depth, num_threads);
+}
+
+/*****************************************************************************
+ * THREAD POOL
+ *****************************************************************************/
+ThreadPoolIOEngine::ThreadPoolIOEngine(size_t queue_depth, size_t num_threads)
+    : queue_depth_(std::max<size_t>(1, queue_depth)) {
+  for (size_t i = 0; i < std::max<size_t>(1, num_threads); i++) {
+    workers_.emplace_back(&ThreadPoolIOEngine::WorkerLoop, this);
+  }
+}
+
+ThreadPoolIOEngine::~ThreadPoolIOEngine() {
+  Drain();
+  {
+    std::scoped_lock lock{latch_};
+    stopped_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPoolIOEngine::SubmitRead(int fd, char *buf, size_t len, off_t offset, Callback done) {
+  Submit(new AsyncIORequest{false, fd, buf, len, offset, 0, {}, std::move(done)});
+}
+
+void ThreadPoolIOEngine::SubmitWrite(int fd, const char *buf, size_t len, off_t offset, Callback done) {
+  // the buffer is only read by pwrite.
+  Submit(new AsyncIORequest{true, fd, const_cast<char *>(buf), len, offset, 0, {}, std::move(done)});
+}
+
+void ThreadPoolIOEngine::Submit(AsyncIORequest *request) {
+  {
+    std::unique_lock lock{latch_};
+    idle_cv_.wait(lock, [this]() { return in_flight_ < queue_depth_; });
+    in_flight_++;
+    queue_.push_back(request);
+  }
+  work_cv_.notify_one();
+}
+
+void ThreadPoolIOEngine::Drain() {
+  std::unique_lock lock{latch_};
+  idle_cv_.wait(lock, [this]() { return in_flight_ == 0; });
+}
+
+void ThreadPoolIOEngine::WorkerLoop() {
+  std::unique_lock lock{latch_};
+  while (true) {
+    work_cv_.wait(lock, [this]() { return stopped_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      break;
+    }
+    AsyncIORequest *request = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+    ssize_t result = 0;
+    while (request->done_ < request->len_) {
+      char *buf = request->buf_ + request->done_;
+      size_t len = request->len_ - request->done_;
+      off_t offset = request->offset_ + request->done_;
+      ssize_t ret = request->is_write_ ? pwrite(request->fd_, buf, len, offset) : pread(request->fd_, buf, len, offset);
+      if (ret < 0 && errno == EINTR) {
+        continue;
+      }
+      if (ret <= 0) {
+        result = ret < 0 ? -errno : 0;
+        break;
+      }
+      request->done_ += ret;
+    }
+    request->callback_(result < 0 ? result : static_cast<ssize_t>(request->done_));
+    delete request;
+    lock.lock();
+    in_flight_--;
+    idle_cv_.notify_all();
+  }
+}
+
+/*****************************************************************************
+ * IO_URING
+ *****************************************************************************/
+namespace {
+// user_data of the no-op which wakes the completion thread up, a request is never at address 0.
+constexpr uint64_t WAKE_UP_USER_DATA = 0;
+
+int io_uring_setup(unsigned entries, struct io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+}  // namespace
+
+std::unique_ptr<IOUringEngine> IOUringEngine::Create(size_t queue_depth, size_t fallback_threads) {
+  std::unique_ptr<IOUringEngine> engine(new IOUringEngine());
+  engine->fallback_threads_ = fallback_threads;
+  if (!engine->Setup(queue_depth)) {
+    return nullptr;
+  }
+  engine->completion_thread_ = std::thread(&IOUringEngine::CompletionLoop, engine.get());
+  return engine;
+}
+
+bool IOUringEngine::Setup(size_t queue_depth) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = io_uring_setup(static_cast<unsigned>(std::max<size_t>(2, queue_depth)), &params);
+  if (ring_fd_ < 0) {
+    return false;
+  }
+  sq_entries_ = params.sq_entries;
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  void *ring = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_SQ_RING);
+  if (ring == MAP_FAILED) {
+    return false;
+  }
+  sq_ring_ = ring;
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+    cq_ring_size_ = 0;  // unmapped with the submission ring
+  } else {
+    ring = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                IORING_OFF_CQ_RING);
+    if (ring == MAP_FAILED) {
+      return false;
+    }
+    cq_ring_ = ring;
+  }
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (ring == MAP_FAILED) {
+    return false;
+  }
+  sqes_ = ring;
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  return true;
+}
+
+IOUringEngine::~IOUringEngine() {
+  if (completion_thread_.joinable()) {
+    Drain();
+    bool woken = true;
+    {
+      std::scoped_lock lock{submit_latch_};
+      stopped_ = true;
+      // the completion thread is gone already if the ring failed
+      if (fallback_ == nullptr) {
+        woken = PushWakeUp();
+      }
+    }
+    if (woken) {
+      completion_thread_.join();
+    } else {
+      // the thread waits on a ring which takes no entry any more, it can not be stopped.
+      LOG(ERROR) << "the io_uring completion thread can not be woken up" << std::endl;
+      completion_thread_.detach();
+    }
+  }
+  fallback_.reset();
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_size_ != 0) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+void IOUringEngine::SubmitRead(int fd, char *buf, size_t len, off_t offset, Callback done) {
+  Submit(new AsyncIORequest{false, fd, buf, len, offset, 0, {}, std::move(done)});
+}
+
+void IOUringEngine::SubmitWrite(int fd, const char *buf, size_t len, off_t offset, Callback done) {
+  // the buffer is only read by the write.
+  Submit(new AsyncIORequest{true, fd, const_cast<char *>(buf), len, offset, 0, {}, std::move(done)});
+}
+
+void IOUringEngine::Submit(AsyncIORequest *request) {
+  std::unique_lock lock{submit_latch_};
+  // one entry is kept for the wake up, the completion ring (twice as large) can not overflow.
+  idle_cv_.wait(lock, [this]() { return fallback_ != nullptr || in_flight_ + 1 < sq_entries_; });
+  if (fallback_ != nullptr) {
+    // the ring failed, the fallback is never reset before the engine is destroyed.
+    ThreadPoolIOEngine *fallback = fallback_.get();
+    lock.unlock();
+    if (request->is_write_) {
+      fallback->SubmitWrite(request->fd_, request->buf_, request->len_, request->offset_, std::move(request->callback_));
+    } else {
+      fallback->SubmitRead(request->fd_, request->buf_, request->len_, request->offset_, std::move(request->callback_));
+    }
+    delete request;
+    return;
+  }
+  in_flight_++;
+  int error = PushRequest(request);
+  lock.unlock();
+  if (error != 0) {
+    LOG(ERROR) << "io_uring submission failed: " << strerror(error) << std::endl;
+    Complete(request, -error);
+  }
+}
+
+void IOUringEngine::Drain() {
+  ThreadPoolIOEngine *fallback;
+  {
+    std::unique_lock lock{submit_latch_};
+    idle_cv_.wait(lock, [this]() { return in_flight_ == 0; });
+    fallback = fallback_.get();
+  }
+  if (fallback != nullptr) {
+    fallback->Drain();
+  }
+}
+
+int IOUringEngine::PushRequest(AsyncIORequest *request) {
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  auto *sqe = static_cast<struct io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  request->iov_.iov_base = request->buf_ + request->done_;
+  request->iov_.iov_len = request->len_ - request->done_;
+  sqe->opcode = request->is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+  sqe->fd = request->fd_;
+  sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+  sqe->len = 1;
+  sqe->off = request->offset_ + request->done_;
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  // the entry is visible to the kernel before the new tail.
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  // the kernel takes the entry at once, the submission ring never stays full.
+  while (io_uring_enter(ring_fd_, 1, 0, 0) < 0) {
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      // nothing was consumed, the entry is taken back so that a later submission does not push it.
+      int error = errno;
+      __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+      return error;
+    }
+  }
+  outstanding_.insert(request);
+  return 0;
+}
+
+bool IOUringEngine::PushWakeUp() {
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  auto *sqe = static_cast<struct io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_NOP;
+  sqe->user_data = WAKE_UP_USER_DATA;
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  while (io_uring_enter(ring_fd_, 1, 0, 0) < 0) {
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+      return false;
+    }
+  }
+  return true;
+}
+
+void IOUringEngine::Complete(AsyncIORequest *request, ssize_t result) {
+  request->callback_(result);
+  delete request;
+  {
+    std::scoped_lock lock{submit_latch_};
+    in_flight_--;
+  }
+  idle_cv_.notify_all();
+}
+
+void IOUringEngine::FailRing(int error) {
+  LOG(ERROR) << "io_uring_enter failed: " << strerror(error) << ", the I/Os are done by a thread pool" << std::endl;
+  std::vector<AsyncIORequest *> failed;
+  {
+    std::scoped_lock lock{submit_latch_};
+    fallback_ = std::make_unique<ThreadPoolIOEngine>(sq_entries_, fallback_threads_);
+    ring_failed_ = true;
+    failed.assign(outstanding_.begin(), outstanding_.end());
+    outstanding_.clear();
+  }
+  // the waiting submitters go to the fallback.
+  idle_cv_.notify_all();
+  for (auto request : failed) {
+    Complete(request, -error);
+  }
+}
+
+void IOUringEngine::CompletionLoop() {
+  auto *cqes = static_cast<struct io_uring_cqe *>(cqes_);
+  while (true) {
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      // wait for a completion
+      if (io_uring_enter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN) {
+        FailRing(errno);
+        return;
+      }
+      continue;
+    }
+    struct io_uring_cqe *cqe = &cqes[head & *cq_mask_];
+    uint64_t user_data = cqe->user_data;
+    int res = cqe->res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    if (user_data == WAKE_UP_USER_DATA) {
+      std::scoped_lock lock{submit_latch_};
+      if (stopped_) {
+        return;
+      }
+      continue;
+    }
+    auto *request = reinterpret_cast<AsyncIORequest *>(user_data);
+    {
+      std::scoped_lock lock{submit_latch_};
+      outstanding_.erase(request);
+    }
+    if (res > 0) {
+      request->done_ += res;
+      if (request->done_ < request->len_) {
+        // short transfer, the rest is submitted again. The request is still counted in flight.
+        int error;
+        {
+          std::scoped_lock lock{submit_latch_};
+          error = PushRequest(request);
+        }
+        if (error == 0) {
+          continue;
+        }
+        LOG(ERROR) << "io_uring submission failed: " << strerror(error) << std::endl;
+        res = -error;
+      }
+    }
+    Complete(request, res < 0 ? res : static_cast<ssize_t>(request->done_));
+  }
+}
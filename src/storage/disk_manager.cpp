@@ -1,5 +1,12 @@
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
 #include <stdexcept>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 #include "storage/disk_manager.h"
@@ -7,8 +14,38 @@
 #include<iostream>
 using namespace std;
 
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, DiskIOBackend backend) : backend_(backend), file_name_(db_file) {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (backend_ == kDiskIOMmapReadOnly) {
+    db_fd_ = open(db_file.c_str(), O_RDONLY);
+    struct stat stat_buf;
+    if (db_fd_ < 0 || fstat(db_fd_, &stat_buf) != 0) {
+      throw std::exception();
+    }
+    // the file does not change while it is opened, the mapping covers it all. It can not be written: the writes are
+    // rejected by the buffer pool, a stray write to a mapped page crashes instead of being lost silently.
+    mapping_size_ = stat_buf.st_size;
+    if (mapping_size_ > 0) {
+      void *mapping = mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, db_fd_, 0);
+      if (mapping == MAP_FAILED) {
+        throw std::exception();
+      }
+      mapping_ = static_cast<char *>(mapping);
+    }
+    ReadPhysicalPage(META_PAGE_ID, meta_data_);
+    LoadMetaData();
+    return;
+  }
+  if (backend_ == kDiskIOPositioned) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+    if (db_fd_ < 0) {
+      throw std::exception();
+    }
+    preallocated_pages_ = (std::max(GetFileSize(file_name_), 0) + PAGE_SIZE - 1) / PAGE_SIZE;
+    ReadPhysicalPage(META_PAGE_ID, meta_data_);
+    LoadMetaData();
+    return;
+  }
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
   // directory or file does not exist
   if (!db_io_.is_open()) {
@@ -23,269 +60,367 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
   ReadPhysicalPage(META_PAGE_ID, meta_data_);
+  LoadMetaData();
 }
 
 void DiskManager::Close() {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if (!closed) {
-    db_io_.close();
+    // the asynchronous I/Os use the file descriptor.
+    if (async_io_engine_ != nullptr) {
+      async_io_engine_->Drain();
+      async_io_engine_.reset();
+    }
+    FlushMetaData();
+    if (mapping_ != nullptr) {
+      munmap(mapping_, mapping_size_);
+      mapping_ = nullptr;
+    }
+    if (backend_ != kDiskIOStream) {
+      close(db_fd_);
+      db_fd_ = -1;
+    } else {
+      db_io_.close();
+    }
     closed = true;
   }
 }
 
 void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
+  // pread does not move a shared cursor, the pages are read without the latch.
+  std::unique_lock<std::recursive_mutex> lock(db_io_latch_, std::defer_lock);
+  if (backend_ == kDiskIOStream) {
+    lock.lock();
+  }
   //ASSERT(logical_page_id >= 0, "Invalid page id.");
   ReadPhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
 void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
+  std::unique_lock<std::recursive_mutex> lock(db_io_latch_, std::defer_lock);
+  if (backend_ == kDiskIOStream) {
+    lock.lock();
+  }
   //ASSERT(logical_page_id >= 0, "Invalid page id.");
   WritePhysicalPage(MapPageId(logical_page_id), page_data);
 }
-void DiskManager::ReadBitMapPage(page_id_t extent_id, char *page_data) {
-  //int extent_id=logical_page_id/BIT_MAP_SIZE;
-  //Page_data will record the data read from the disk
-  page_id_t BitMap_Index=extent_id*(BITMAP_SIZE+1)+1;
-  //Read the Bit map from the disk
-  ReadPhysicalPage(BitMap_Index,page_data);
-}
-
-
-page_id_t DiskManager::AllocatePage() {
-  //0.Update Disk_File_Meta_page
-  //1.We need to linear Search the Extent,and find the Extent which is not full
-  //2.After we get the extent,The We need to read bitmap in that Extent from the disk
-  //3.Using the bitmap to NextFreePage_id
-  //4.Get the Logical_Page_id(Extent_id*BIT_MAP_SIZE+NextFreePage_id)
-  //5.Write back to the Physical Disk--------WritePhysicalPage(MapPageId(Logical_Page_id),Page_Data)
-  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(this->meta_data_);
-  uint32_t NextPage=0;
-  //Situation 0: if this is the first Allocation
-  if(meta_page->GetExtentNums()==0)
-  {
-    // std::cout<<"num_extents_--------" <<meta_page->num_extents_<<endl;
-    // std::cout<<"num_allocated_pages_--------" <<meta_page->num_allocated_pages_<<endl;
-    // std::cout<<"extent_used_page[0]--------" <<meta_page->extent_used_page_[0]<<endl;
-    //First Part-Update Disk_File_Meta_Data
-    //Allocate num_extents
-    meta_page->num_extents_++;
-    //Update num_allocated_page
-    meta_page->num_allocated_pages_++;
-    //Update extent_used_page
-    meta_page->extent_used_page_[0]=1;
-
-    //Second Part-Update the BitMap
-    //Read BitMap from the corresponding  extent
-    char Page_Data[PAGE_SIZE];//Page_data will record the data read from the disk
-    // ReadBitMapPage(0,Page_Data);
-    ReadPhysicalPage(1,Page_Data);
-    
-    // for(int i=0;i<10;i++)
-    // {
-    //   ReadPhysicalPage((i)*(BITMAP_SIZE+1)+1,Page_Data);
-    //   BitmapPage<PAGE_SIZE> *Bitmap_page = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(Page_Data);
-    //   std::cout<<"PageAllocated "<<(i)*(BITMAP_SIZE+1)+1<<"------------- "<<Bitmap_page->page_allocated_<<std::endl;
-    //   std::cout<<"MaxSupportSize------------- "<<Bitmap_page->GetMaxSupportedSize()<<std::endl; 
-    // }
-    
-    //Allocate Page
-    BitmapPage<PAGE_SIZE> *Bitmap_page = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(Page_Data);
-    bool state=Bitmap_page->AllocatePage(NextPage);
-    if(state)
-    {
-      //In the Disk Storage Layout, page 1 is the First BitMapPage
-      //Write Back Page 1 to the Disk
-      //std::cout<<"Allocate Success"<<std::endl;
-      char *Page_Data = reinterpret_cast<char *>(Bitmap_page);
-      WritePhysicalPage(1,Page_Data);
+void DiskManager::WritePages(std::vector<PageWrite> *pages) {
+  std::sort(pages->begin(), pages->end(), [](const PageWrite &a, const PageWrite &b) {
+    return a.logical_page_id_ < b.logical_page_id_;
+  });
+  if (backend_ != kDiskIOPositioned) {
+    std::unique_lock<std::recursive_mutex> lock(db_io_latch_, std::defer_lock);
+    if (backend_ == kDiskIOStream) {
+      lock.lock();
     }
-    else
-    {
-      // std::cout<<"PageAllocated------------- "<<Bitmap_page->page_allocated_<<std::endl;
-      // std::cout<<"MaxSupportSize------------- "<<Bitmap_page->GetMaxSupportedSize()<<std::endl;
-      std::cerr<<"Error----AllocatePage Failed1"<<std::endl;
+    for (auto &page : *pages) {
+      WritePhysicalPage(MapPageId(page.logical_page_id_), page.page_data_);
     }
+    return;
   }
-  //Situation 1: General Case.
-  else {
-    //First Part: -> Update disk_file_meta_page
-    //1.Update num_allocated_pages first
-    meta_page->num_allocated_pages_++;
-    //2.Find the Last extent which is not full
-    int flag=0;
-    uint32_t i;
-    for (i=0; i < meta_page->num_extents_; i++)
-    {
-      if (meta_page->extent_used_page_[i] < BITMAP_SIZE)
-      {
-        flag=1;
-        break;
-      }
+  // the logical order is the physical order. A run ends at a gap, at the bitmap page of the next extent, or when it
+  // has IOV_MAX pages.
+  std::vector<struct iovec> iov;
+  iov.reserve(std::min<size_t>(pages->size(), IOV_MAX));
+  page_id_t first_physical_page_id = INVALID_PAGE_ID;
+  for (auto &page : *pages) {
+    page_id_t physical_page_id = MapPageId(page.logical_page_id_);
+    if (!iov.empty() && (physical_page_id != first_physical_page_id + static_cast<page_id_t>(iov.size()) ||
+                         iov.size() == IOV_MAX)) {
+      WritePhysicalPages(first_physical_page_id, iov.data(), iov.size());
+      iov.clear();
     }
-    //3.Check the overflow of the current extents
-    if(flag==0)
-    {
-      //it means the current extents are all full.
-      //Used New extent
-      i = meta_page->num_extents_++;
-      meta_page->extent_used_page_[i]++;
+    if (iov.empty()) {
+      first_physical_page_id = physical_page_id;
     }
-    else
-    {
-      //it means the current extents are not full.
-      // original code: meta_page->extent_used_page_[meta_page->num_extents_ - 1]++;
-      meta_page->extent_used_page_[i]++;
+    iov.push_back({const_cast<char *>(page.page_data_), PAGE_SIZE});
+  }
+  if (!iov.empty()) {
+    WritePhysicalPages(first_physical_page_id, iov.data(), iov.size());
+  }
+}
+
+void DiskManager::Sync() {
+  // cleared before the fsync, a write made during the fsync is synced by the next call.
+  if (IsReadOnly() || closed || !unsynced_.exchange(false)) {
+    return;
+  }
+  if (backend_ == kDiskIOPositioned) {
+    if (fsync(db_fd_) != 0) {
+      LOG(ERROR) << "I/O error while syncing";
     }
+    return;
+  }
+  // the stream has no file descriptor, the file is synced through one of its own.
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  db_io_.flush();
+  int fd = open(file_name_.c_str(), O_RDONLY);
+  if (fd < 0 || fsync(fd) != 0) {
+    LOG(ERROR) << "I/O error while syncing";
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+}
 
-    // i is the corresponding extent_id of this allocate
+AsyncIOEngine *DiskManager::GetAsyncIOEngine() {
+  if (backend_ != kDiskIOPositioned || closed) {
+    return nullptr;
+  }
+  std::call_once(async_io_engine_once_,
+                 [this]() { async_io_engine_ = AsyncIOEngine::Create(ASYNC_IO_QUEUE_DEPTH, ASYNC_IO_THREADS); });
+  return async_io_engine_.get();
+}
 
-    //Second Part- Read BitMap
-    char Page_Data[PAGE_SIZE];
-    ReadBitMapPage(i,Page_Data);
-    //Thrid Part- Allocate Page
-    BitmapPage<PAGE_SIZE> *Bitmap_page = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(Page_Data);
-    bool state = Bitmap_page->AllocatePage(NextPage);
-    
-    if(state==true)
-    {
-      page_id_t BitMap_page_id=i*(BITMAP_SIZE+1)+1;  
-      //Write Back BitMap Page  to the Disk
-      char *Page_Data = reinterpret_cast<char *>(Bitmap_page);
-      WritePhysicalPage(BitMap_page_id,Page_Data);
-      NextPage += i*BITMAP_SIZE; // the extent_id * (number of data pages) + page number in the extent => logical page id.
+void DiskManager::ReadPageAsync(page_id_t logical_page_id, char *page_data, std::function<void(bool)> done) {
+  AsyncIOEngine *engine = GetAsyncIOEngine();
+  if (engine == nullptr) {
+    ReadPage(logical_page_id, page_data);
+    done(true);
+    return;
+  }
+  off_t offset = static_cast<off_t>(MapPageId(logical_page_id)) * PAGE_SIZE;
+  engine->SubmitRead(db_fd_, page_data, PAGE_SIZE, offset, [page_data, done](ssize_t result) {
+    // the page is beyond the end of the file, or the file ends before PAGE_SIZE
+    if (result >= 0 && result < PAGE_SIZE) {
+      memset(page_data + result, 0, PAGE_SIZE - result);
     }
-    else
-    {
-      std::cerr<<"Error----AllocatePage Failed2"<<std::endl;
+    if (result < 0) {
+      LOG(ERROR) << "I/O error while reading";
     }
+    done(result >= 0);
+  });
+}
+
+void DiskManager::WritePageAsync(page_id_t logical_page_id, const char *page_data, std::function<void(bool)> done) {
+  AsyncIOEngine *engine = GetAsyncIOEngine();
+  if (engine == nullptr) {
+    WritePage(logical_page_id, page_data);
+    done(true);
+    return;
   }
-  
-  return NextPage;
+  off_t offset = static_cast<off_t>(MapPageId(logical_page_id)) * PAGE_SIZE;
+  engine->SubmitWrite(db_fd_, page_data, PAGE_SIZE, offset, [this, done](ssize_t result) {
+    if (result != PAGE_SIZE) {
+      LOG(ERROR) << "I/O error while writing";
+    } else {
+      unsynced_ = true;
+    }
+    done(result == PAGE_SIZE);
+  });
 }
 
-void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
-  
-  //0.Update Disk_File_Meta_page
-  //1.Convert the logical_page_id to Physical_page_id
-  //2.if we DeAllocatePage, We may need to update num_extents_
-  //3.Then We need to read bitmap in that Extent from the disk
-  //4.Using the bitmap to Deallocate the logical_page_id%BITMAX_Size
-  //5.Write back to the Physical Disk--------WritePhysicalPage(MapPageId(Logical_Page_id),Page_Data)
-  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(this->meta_data_);
+std::future<bool> DiskManager::ReadPageAsync(page_id_t logical_page_id, char *page_data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  std::future<bool> future = promise->get_future();
+  ReadPageAsync(logical_page_id, page_data, [promise](bool ok) { promise->set_value(ok); });
+  return future;
+}
 
-  page_id_t Physical_Page_Id = this->MapPageId(logical_page_id);
-  //Situation 0: if the extents is Empty, We could not DeAllocate.
-  if(meta_page->GetExtentNums()==0)
-  {
-    // std::cerr<<"Error- Can not DeAllocate the Extent"<<std::endl;
-    return ; // stop the execution of the rest of the function.
+std::future<bool> DiskManager::WritePageAsync(page_id_t logical_page_id, const char *page_data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  std::future<bool> future = promise->get_future();
+  WritePageAsync(logical_page_id, page_data, [promise](bool ok) { promise->set_value(ok); });
+  return future;
+}
+
+void DiskManager::WaitForAsyncIO() {
+  AsyncIOEngine *engine = GetAsyncIOEngine();
+  if (engine != nullptr) {
+    engine->Drain();
   }
+}
 
-  //Situation 1: if the extents only has one page, so if we delete the extents, we need to update diskFileData
-  
-  //page_id_t physical_page_id=MapPageId(logical_page_id);
-  int extent_id=logical_page_id/BITMAP_SIZE;
-  //Situation 1.1: if the extents only has one page, and that is not free.
-  if(meta_page->extent_used_page_[extent_id]==1&&IsPageFree(logical_page_id)==false)
-  {
-    //Update the Disk_File_Meta_Data
-    meta_page->num_allocated_pages_--;
-    //original code: meta_page->num_extents_--;
-    // the reason for changing -> comment this code away. 
-    // Because this extent(with 0 data pages) might not be the tail, 
-    // simply decrease the extents num might cause problem while allocating a new one.
-    meta_page->extent_used_page_[extent_id]=0;
-    //Read the Corresponding BitMap From the Disk,DeAllocate the BitMap
-    char Page_Data[PAGE_SIZE];
-    ReadBitMapPage(extent_id,Page_Data);
-    BitmapPage<PAGE_SIZE> *Bitmap_page = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(Page_Data);
+const char *DiskManager::GetAsyncIOEngineName() {
+  AsyncIOEngine *engine = GetAsyncIOEngine();
+  return engine == nullptr ? "sync" : engine->GetName();
+}
 
-    char Init_Page_Data[PAGE_SIZE];
-    for (int i = 0; i < PAGE_SIZE; i++) 
-    {
-      Init_Page_Data[i] = '\0';
-    }
+const char *DiskManager::GetMappedPage(page_id_t logical_page_id) {
+  if (mapping_ == nullptr || logical_page_id < 0) {
+    return nullptr;
+  }
+  size_t offset = static_cast<size_t>(MapPageId(logical_page_id)) * PAGE_SIZE;
+  if (offset + PAGE_SIZE > mapping_size_) {
+    return nullptr;
+  }
+  return mapping_ + offset;
+}
+
+void DiskManager::ReadBitMapPage(page_id_t extent_id, char *page_data) {
+  //int extent_id=logical_page_id/BIT_MAP_SIZE;
+  //Page_data will record the data read from the disk
+  page_id_t BitMap_Index=extent_id*(BITMAP_SIZE+1)+1;
+  //Read the Bit map from the disk
+  ReadPhysicalPage(BitMap_Index,page_data);
+}
+
+BitmapPage<PAGE_SIZE> *DiskManager::GetBitmap(uint32_t extent_id) {
+  if (extent_id >= bitmaps_.size()) {
+    bitmaps_.resize(extent_id + 1);
+    bitmap_summaries_.resize(extent_id + 1);
+    bitmap_dirty_.resize(extent_id + 1, false);
+  }
+  if (bitmaps_[extent_id] == nullptr) {
+    bitmaps_[extent_id].reset(new BitmapPage<PAGE_SIZE>());
+    ReadBitMapPage(extent_id, reinterpret_cast<char *>(bitmaps_[extent_id].get()));
+    bitmaps_[extent_id]->BuildSummary(&bitmap_summaries_[extent_id]);
+  }
+  return bitmaps_[extent_id].get();
+}
 
-    //DeAllocate the bitmap
-    bool state=Bitmap_page->DeAllocatePage(logical_page_id%BITMAP_SIZE);
-    if(state==true)
-    {
-      //std::cout<<"Situation 1.1-----disk_manager::DeAllocate()------Success"<<std::endl;
-      //Write Back to the Disk
-      page_id_t BitMap_page_id=extent_id*(BITMAP_SIZE+1)+1;  
-      //Write Back BitMap Page  to the Disk
-      char *Page_Data = reinterpret_cast<char *>(Bitmap_page);
-      WritePhysicalPage(BitMap_page_id,Page_Data);
-      WritePhysicalPage(Physical_Page_Id, Init_Page_Data);
+void DiskManager::LoadMetaData() {
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  if (meta_page->num_extents_ == 0) {
+    // the extents whose bitmap page is in the file
+    int file_size = GetFileSize(file_name_);
+    uint32_t max_extents = MAX_VALID_PAGE_ID / BITMAP_SIZE;
+    for (uint32_t i = 0; i < max_extents && static_cast<int64_t>(i * (BITMAP_SIZE + 1) + 1) * PAGE_SIZE < file_size;
+         i++) {
+      uint32_t used = GetBitmap(i)->page_allocated_;
+      meta_page->extent_used_page_[i] = used;
+      meta_page->num_allocated_pages_ += used;
+      if (used > 0) {
+        meta_page->num_extents_ = i + 1;
+      }
+    }
+    meta_dirty_ = meta_page->num_extents_ > 0;
+  }
+  first_free_extent_ = 0;
+  while (first_free_extent_ < meta_page->num_extents_ &&
+         meta_page->extent_used_page_[first_free_extent_] >= BITMAP_SIZE) {
+    first_free_extent_++;
+  }
+}
 
+page_id_t DiskManager::AllocatePage(page_id_t near_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (IsReadOnly()) {
+    LOG(ERROR) << "Can not allocate a page, the db file is opened read only";
+    return INVALID_PAGE_ID;
+  }
+  // the page is taken from the cached bitmaps, nothing is read or written here.
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  uint32_t page_offset = 0;
+  if (near_page_id != INVALID_PAGE_ID && near_page_id >= 0) {
+    // the page after the neighbour, or a new run in the extent of the neighbour.
+    uint32_t goal = near_page_id + 1;
+    uint32_t extent_id = goal / BITMAP_SIZE;
+    if (extent_id < meta_page->num_extents_ && meta_page->extent_used_page_[extent_id] < BITMAP_SIZE &&
+        GetBitmap(extent_id)->AllocatePageNear(goal % BITMAP_SIZE, page_offset, &bitmap_summaries_[extent_id])) {
+      return OnPageAllocated(extent_id, page_offset);
     }
-    else
-    {
-      std::cerr<<"Situation 1.1-----disk_manager::DeAllocate()------Failed"<<std::endl;
-      WritePhysicalPage(Physical_Page_Id, Init_Page_Data);
-      return;
+  }
+  // the first free page of the first extent which is not full.
+  uint32_t extent_id = first_free_extent_;
+  if (extent_id == meta_page->num_extents_) {
+    // all the extents are full, use a new one
+    if (extent_id >= MAX_VALID_PAGE_ID / BITMAP_SIZE) {
+      LOG(ERROR) << "The db file is full";
+      return INVALID_PAGE_ID;
     }
+    meta_page->num_extents_++;
+    meta_page->extent_used_page_[extent_id] = 0;
+  }
+  BitmapPage<PAGE_SIZE> *bitmap = GetBitmap(extent_id);
+  if (!bitmap->AllocatePage(page_offset, &bitmap_summaries_[extent_id])) {
+    std::cerr << "Error----AllocatePage Failed" << std::endl;
+    return INVALID_PAGE_ID;
+  }
+  return OnPageAllocated(extent_id, page_offset);
+}
+
+void DiskManager::SetGrowthChunk(size_t chunk_pages) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  growth_chunk_pages_ = chunk_pages;
+}
+
+void DiskManager::GrowFile(page_id_t physical_page_id) {
+  if (backend_ != kDiskIOPositioned || growth_chunk_pages_ <= 1 ||
+      static_cast<size_t>(physical_page_id) < preallocated_pages_) {
+    return;
   }
-  //Situation 1.2: if the extents only has one page, and that page is free.
-  else if(meta_page->extent_used_page_[extent_id]==1&&IsPageFree(logical_page_id)==true)
-  {
-    std::cerr<<"Situation 1.2-----Can not Deallocate,Page "<<logical_page_id<<" is Free"<<std::endl;
+  // up to the end of the chunk holding the page, the bitmap page of a new extent is in the range as well.
+  size_t end = (physical_page_id / growth_chunk_pages_ + 1) * growth_chunk_pages_;
+  off_t offset = static_cast<off_t>(preallocated_pages_) * PAGE_SIZE;
+  off_t len = static_cast<off_t>(end - preallocated_pages_) * PAGE_SIZE;
+  if (fallocate(db_fd_, FALLOC_FL_KEEP_SIZE, offset, len) != 0) {
+    // not supported by the file system, the file grows with the writes.
+    LOG(WARNING) << "Can not preallocate the db file: " << strerror(errno);
+    growth_chunk_pages_ = 0;
     return;
   }
-  //Situation 2: General Case.
-  else{
-    // uint32_t num_allocated_pages_{0};
-    // uint32_t num_extents_{0};   // each extent consists with a bit map and BIT_MAP_SIZE pages
-    // uint32_t extent_used_page_[0];
+  preallocated_pages_ = end;
+}
 
-    //First Part: -> Update disk_file_meta_page
-    //1.Update num_allocated_pages first
-    meta_page->extent_used_page_[extent_id]--;
-    meta_page->num_allocated_pages_--;
-    //Second Part: -> Read BitMap
-    char Page_Data[PAGE_SIZE];
-    ReadBitMapPage(extent_id,Page_Data);
-    //Thrid Part: -> Allocate Page
-    BitmapPage<PAGE_SIZE> *Bitmap_page = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(Page_Data);
-    bool state = Bitmap_page->DeAllocatePage(logical_page_id%BITMAP_SIZE);
+page_id_t DiskManager::OnPageAllocated(uint32_t extent_id, uint32_t page_offset) {
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  GrowFile(MapPageId(extent_id * BITMAP_SIZE + page_offset));
+  bitmap_dirty_[extent_id] = true;
+  meta_page->num_allocated_pages_++;
+  meta_page->extent_used_page_[extent_id]++;
+  meta_dirty_ = true;
+  while (first_free_extent_ < meta_page->num_extents_ &&
+         meta_page->extent_used_page_[first_free_extent_] >= BITMAP_SIZE) {
+    first_free_extent_++;
+  }
+  // the extent_id * (number of data pages) + page number in the extent => logical page id.
+  return extent_id * BITMAP_SIZE + page_offset;
+}
 
-    char Init_Page_Data[PAGE_SIZE];
-    for (int i = 0; i < PAGE_SIZE; i++) {
-      Init_Page_Data[i] = '\0';
-    }
-    
-    if(state==true)
-    {
-      page_id_t BitMap_page_id=(extent_id)*(BITMAP_SIZE+1)+1;  
-      //std::cout<<"Situation 2.1-----disk_manager::DeAllocate()------Success"<<std::endl;
-      //Write Back BitMap Page  to the Disk
-      char *Page_Data = reinterpret_cast<char *>(Bitmap_page);
-      WritePhysicalPage(BitMap_page_id,Page_Data);
-      WritePhysicalPage(Physical_Page_Id, Init_Page_Data);
-    }
-    else
-    {
-      std::cerr<<"Situation 2.1-----disk_manager::DeAllocate-----Failed"<<std::endl;
-      WritePhysicalPage(Physical_Page_Id, Init_Page_Data);
-      return;
-    }
+void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  if (logical_page_id < 0 || IsReadOnly()) {
+    return;
   }
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  // if the extent is not used, We could not DeAllocate.
+  if (extent_id >= meta_page->num_extents_) {
+    return;
+  }
+  BitmapPage<PAGE_SIZE> *bitmap = GetBitmap(extent_id);
+  if (!bitmap->DeAllocatePage(logical_page_id % BITMAP_SIZE, &bitmap_summaries_[extent_id])) {
+    std::cerr << "Can not Deallocate, Page " << logical_page_id << " is Free" << std::endl;
+    return;
+  }
+  bitmap_dirty_[extent_id] = true;
+  // an extent with 0 data pages is kept, it might not be the tail.
+  meta_page->extent_used_page_[extent_id]--;
+  meta_page->num_allocated_pages_--;
+  meta_dirty_ = true;
+  first_free_extent_ = std::min(first_free_extent_, extent_id);
+  // the page is read as zeros if it is allocated again
+  char init_page_data[PAGE_SIZE];
+  memset(init_page_data, 0, PAGE_SIZE);
+  WritePhysicalPage(MapPageId(logical_page_id), init_page_data);
 }
 
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
-  //1.First Find the Corresponding Extent_id.
-  //2.Second Read the bitMap.
-  //3.Using the bitMap to determine Whether the Logical_page_id is Free or not.
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  if (extent_id >= meta_page->num_extents_) {
+    return true;
+  }
+  return GetBitmap(extent_id)->IsPageFree(logical_page_id % BITMAP_SIZE);
+}
 
-  char Page_Data[PAGE_SIZE];//Page_data will record the data read from the disk
-  int extent_id=logical_page_id/BITMAP_SIZE;
-  ReadBitMapPage(extent_id,Page_Data);
-  //Convert the Logical_page_id to the Every Extent Pageid
-  page_id_t Bitmap_page_id=logical_page_id%BITMAP_SIZE;
-  BitmapPage<PAGE_SIZE> * bitmap_page = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(Page_Data);
-  //Get the state of the page
-  bool state=bitmap_page->IsPageFree(Bitmap_page_id);
-  return state;
+void DiskManager::FlushMetaData() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (closed || IsReadOnly()) {
+    return;
+  }
+  for (size_t i = 0; i < bitmaps_.size(); i++) {
+    if (bitmap_dirty_[i]) {
+      WritePhysicalPage(i * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char *>(bitmaps_[i].get()));
+      bitmap_dirty_[i] = false;
+    }
+  }
+  if (meta_dirty_) {
+    WritePhysicalPage(META_PAGE_ID, meta_data_);
+    meta_dirty_ = false;
+  }
 }
 
 page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
@@ -304,6 +439,28 @@ int DiskManager::GetFileSize(const std::string &file_name) {
 }
 
 void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
+  if (backend_ != kDiskIOStream) {
+    off_t offset = static_cast<off_t>(physical_page_id) * PAGE_SIZE;
+    size_t read_count = 0;
+    while (read_count < PAGE_SIZE) {
+      ssize_t ret = pread(db_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+      if (ret < 0 && errno == EINTR) {
+        continue;
+      }
+      if (ret < 0) {
+        LOG(ERROR) << "I/O error while reading";
+      }
+      if (ret <= 0) {
+        break;
+      }
+      read_count += ret;
+    }
+    // the page is beyond the end of the file, or the file ends before PAGE_SIZE
+    if (read_count < PAGE_SIZE) {
+      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    }
+    return;
+  }
   int offset = physical_page_id * PAGE_SIZE;
   // check if read beyond file length
   if (offset >= GetFileSize(file_name_)) {
@@ -328,6 +485,26 @@ void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data)
 
 void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
   size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
+  if (IsReadOnly()) {
+    LOG(ERROR) << "Can not write a page, the db file is opened read only";
+    return;
+  }
+  if (backend_ == kDiskIOPositioned) {
+    size_t write_count = 0;
+    while (write_count < PAGE_SIZE) {
+      ssize_t ret = pwrite(db_fd_, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+      if (ret < 0 && errno == EINTR) {
+        continue;
+      }
+      if (ret <= 0) {
+        LOG(ERROR) << "I/O error while writing";
+        return;
+      }
+      write_count += ret;
+    }
+    unsynced_ = true;
+    return;
+  }
   // set write cursor to offset
   db_io_.seekp(offset);
   db_io_.write(page_data, PAGE_SIZE);
@@ -338,4 +515,31 @@ void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page
   }
   // needs to flush to keep disk file in sync
   db_io_.flush();
-}
\ No newline at end of file
+  unsynced_ = true;
+}
+
+void DiskManager::WritePhysicalPages(page_id_t first_physical_page_id, struct iovec *iov, int iovcnt) {
+  off_t offset = static_cast<off_t>(first_physical_page_id) * PAGE_SIZE;
+  while (iovcnt > 0) {
+    ssize_t ret = pwritev(db_fd_, iov, iovcnt, offset);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      LOG(ERROR) << "I/O error while writing";
+      return;
+    }
+    // a short write: skip the iovecs written, and the part written of the next one.
+    offset += ret;
+    while (iovcnt > 0 && static_cast<size_t>(ret) >= iov->iov_len) {
+      ret -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + ret;
+      iov->iov_len -= ret;
+    }
+  }
+  unsynced_ = true;
+}
@@ -1,52 +1,113 @@
 ﻿#include "storage/table_heap.h"
 
 bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return false;
+  }
+  uint32_t tuple_size = row.GetSerializedSize(schema_);
+  // if the Tuple is Larger than PageSize
+  if (tuple_size > TablePage::SIZE_MAX_ROW) return false;
+  if (free_space_map_page_id_ == INVALID_PAGE_ID) {
+    return InsertTupleLinear(row, txn);
+  }
+  while (true) {
+    page_id_t page_id = FindPageWithSpace(tuple_size);
+    if (page_id == INVALID_PAGE_ID) {
+      page_id = AppendPage(txn);
+      if (page_id == INVALID_PAGE_ID) {
+        return false;
+      }
+    }
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(page_id);
+    auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+    bool inserted = page->InsertTuple(row, this->schema_, txn, this->lock_manager_, this->log_manager_);
+    if (inserted) {
+      guard.SetDirty();
+    }
+    // the page may have been filled by another insert since it was found, its room is recorded again either way.
+    RecordFreeSpace(page);
+    if (inserted) {
+      return true;
+    }
+  }
+}
+
+bool TableHeap::InsertTuples(std::vector<Row> &rows, Transaction *txn) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return false;
+  }
+  for (auto &row : rows) {
+    if (row.GetSerializedSize(schema_) > TablePage::SIZE_MAX_ROW) return false;
+  }
+  if (free_space_map_page_id_ == INVALID_PAGE_ID) {
+    for (auto &row : rows) {
+      if (!InsertTupleLinear(row, txn)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  size_t next = 0;
+  // once a page had to be appended, the map has no room for the rest of the batch either.
+  bool appending = false;
+  while (next < rows.size()) {
+    page_id_t page_id = INVALID_PAGE_ID;
+    if (!appending) {
+      page_id = FindPageWithSpace(rows[next].GetSerializedSize(schema_));
+    }
+    if (page_id == INVALID_PAGE_ID) {
+      page_id = AppendPage(txn);
+      if (page_id == INVALID_PAGE_ID) {
+        return false;
+      }
+      appending = true;
+    }
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(page_id);
+    auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+    size_t first = next;
+    while (next < rows.size() &&
+           page->InsertTuple(rows[next], this->schema_, txn, this->lock_manager_, this->log_manager_)) {
+      next++;
+    }
+    if (next > first) {
+      guard.SetDirty();
+    }
+    RecordFreeSpace(page);
+  }
+  return true;
+}
+
+bool TableHeap::InsertTupleLinear(Row &row, Transaction *txn) {
   // Linear Search the tableHeap, Find the Empty Page
   for (page_id_t i = this->GetFirstPageId(); i != INVALID_PAGE_ID;) {
-    auto Page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(i));
-    // if the Tuple is Larger than PageSize
-    if (row.GetSerializedSize(schema_) > Page->SIZE_MAX_ROW) return false;
-
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(i);
+    auto page = reinterpret_cast<TablePage *>(guard.GetPage());
     // If Find one Insert Tuple,and Update RowId
-    Page->WLatch();
-    bool state = Page->InsertTuple(row, this->schema_, txn, this->lock_manager_, this->log_manager_);
-    Page->WUnlatch();
-    if (state == true) {
-      buffer_pool_manager_->UnpinPage(i, true);
-
+    if (page->InsertTuple(row, this->schema_, txn, this->lock_manager_, this->log_manager_)) {
+      guard.SetDirty();
       return true;
-    } else {
-      // it means current page can not allocate thi s page
-      buffer_pool_manager_->UnpinPage(i, false);
-      // Situation1:if the Current Page's Next Page Id is valid, it means do not need to set the Next Page id
-      if (Page->GetNextPageId() != INVALID_PAGE_ID) {
-        i = Page->GetNextPageId();
-        continue;
-      } else {
-        // Situation2:if the Current Page's Next Page Id is Invalid, it means need to set the Next Page id
-        // Allocate New Page
-        i = AllocateNewPage(i, buffer_pool_manager_, txn, lock_manager_, log_manager_);
-        Page->SetNextPageId(i);
-        buffer_pool_manager_->UnpinPage(i, true);
-      }
     }
-
-    i = Page->GetNextPageId();
+    // it means current page can not allocate this tuple
+    if (page->GetNextPageId() == INVALID_PAGE_ID) {
+      // the Current Page is the last one, link a New Page after it
+      page->SetNextPageId(AllocateNewPage(i, buffer_pool_manager_, txn, lock_manager_, log_manager_));
+      guard.SetDirty();
+    }
+    i = page->GetNextPageId();
   }
   return false;
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!guard) {
     return false;
   }
   // Otherwise, mark the tuple as deleted.
-  page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
+  reinterpret_cast<TablePage *>(guard.GetPage())->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  guard.SetDirty();
   return true;
 }
 
@@ -58,67 +119,57 @@ bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
  * @return true is update is successful.
  */
 bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard) {
+    return false;
+  }
+  auto page = reinterpret_cast<TablePage *>(guard.GetPage());
   // Get OldRow
   Row OldRow(rid);
   // using UpdateTuple to update the Tuple
   int state = page->UpdateTuple(row, &OldRow, schema_, txn, lock_manager_, log_manager_);
-  bool result = true;
-  // Situation1: it is Invalid_Slot_number
-  if (state == INVALID_SLOT_NUMBER) {
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    result = false;
-
-  }
-  // Situation2: it is Already Deleted.
-  else if (state == TUPLE_DELETED) {
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    result = false;
-
+  // Situation1: it is Invalid_Slot_number, Situation2: it is Already Deleted.
+  if (state == INVALID_SLOT_NUMBER || state == TUPLE_DELETED) {
+    return false;
   }
   // Situation3: it is not enough Space to Update into Current Page
-  else if (state == NOT_ENOUGH_SPACE) {
-    // DeleteTuple Insert into Other Page
+  if (state == NOT_ENOUGH_SPACE) {
+    // DeleteTuple Insert into Other Page, the page is released first because the insert may latch it again
     page->ApplyDelete(rid, txn, log_manager_);
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
-    if (this->InsertTuple(row, txn)) {
-      result = true;
-    } else {
-      result = false;
-    }
-
-  } else if (state == 1) {
-    // Replace Record on Original Place
-    row.SetRowId(rid);
-    // UnpinPage and update page into disk until lru replacer replace it.
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
-    result = true;
-  }
-  return result;
+    guard.SetDirty();
+    RecordFreeSpace(page);
+    guard.Drop();
+    return this->InsertTuple(row, txn);
+  }
+  // Replace Record on Original Place, the page is written back when the replacer evicts it.
+  row.SetRowId(rid);
+  guard.SetDirty();
+  RecordFreeSpace(page);
+  return true;
 }
 
 void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   // Step1: Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard) {
+    return;
+  }
   // Step2: Delete the tuple from the page.
-  page->WLatch();
+  auto page = reinterpret_cast<TablePage *>(guard.GetPage());
   page->ApplyDelete(rid, txn, log_manager_);
-  page->WUnlatch();
-
-  // UnpinPage To Delete Page
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  guard.SetDirty();
+  RecordFreeSpace(page);
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  assert(page != nullptr);
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard) {
+    return;
+  }
   // Rollback the delete.
-  page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  reinterpret_cast<TablePage *>(guard.GetPage())->RollbackDelete(rid, txn, log_manager_);
+  guard.SetDirty();
 }
 
 void TableHeap::FreeHeap() {
@@ -143,13 +194,29 @@ void TableHeap::FreeHeap() {
   }*/
   page_id_t next = GetFirstPageId();
   for (page_id_t i = GetFirstPageId(); i != INVALID_PAGE_ID; i = next) {
-    Page *page_orig = buffer_pool_manager_->FetchPage(i);
-    auto page = reinterpret_cast<TablePage *>(page_orig->GetData());
-    if (page->GetPinCount() > 0) buffer_pool_manager_->UnpinPage(i, false);
-    next = page->GetNextPageId();
-    bool state = buffer_pool_manager_->DeletePage(i);
-    if (state == false) {
-      std::cerr << "TableHeap::FreeHeap Failed" << endl;
+    BasicPageGuard guard = buffer_pool_manager_->FetchPageBasic(i);
+    next = reinterpret_cast<TablePage *>(guard.GetPage())->GetNextPageId();
+    // the page can only be deleted once unpinned
+    guard.Drop();
+    [[maybe_unused]] bool deleted = buffer_pool_manager_->DeletePage(i);
+    ASSERT(deleted, "A page of the heap is still pinned, is an iterator alive?");
+  }
+  // then the pages of the free space map
+  if (free_space_map_page_id_ != INVALID_PAGE_ID) {
+    std::vector<page_id_t> leaf_page_ids;
+    {
+      ReadPageGuard root_guard = buffer_pool_manager_->FetchPageRead(free_space_map_page_id_);
+      auto root = root_guard.As<FreeSpaceMapRootPage>();
+      for (uint32_t i = 0; i < FreeSpaceMapRootPage::MAX_LEAVES; i++) {
+        if (root->GetLeafPageId(i) != INVALID_PAGE_ID) {
+          leaf_page_ids.push_back(root->GetLeafPageId(i));
+        }
+      }
+    }
+    leaf_page_ids.push_back(free_space_map_page_id_);
+    for (auto page_id : leaf_page_ids) {
+      [[maybe_unused]] bool deleted = buffer_pool_manager_->DeletePage(page_id);
+      ASSERT(deleted, "A page of the free space map is still pinned.");
     }
   }
   // Free All the Schema
@@ -159,45 +226,141 @@ void TableHeap::FreeHeap() {
   }
 }
 
-bool TableHeap::GetTuple(Row *row, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage((row->GetRowId()).GetPageId()));
-  bool state = page->GetTuple(row, this->schema_, txn, this->lock_manager_);
-  buffer_pool_manager_->UnpinPage((row->GetRowId()).GetPageId(), false);
-  return state;
+bool TableHeap::GetTuple(Row *row, Transaction *txn, const std::vector<uint32_t> *column_ids) {
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead((row->GetRowId()).GetPageId());
+  return reinterpret_cast<TablePage *>(guard.GetPage())
+      ->GetTuple(row, this->schema_, txn, this->lock_manager_, column_ids);
 }
+
 page_id_t TableHeap::AllocateNewPage(page_id_t last_page_id, BufferPoolManager *buffer_pool_manager_, Transaction *txn,
                                      LockManager *lock_manager, LogManager *log_manager) {
   page_id_t new_page_id = INVALID_PAGE_ID;
-  TablePage *NewPage = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+  // allocated after the last page on disk, so a scan of the heap reads the file mostly sequentially.
+  BasicPageGuard guard = buffer_pool_manager_->NewPageGuardedNear(new_page_id, last_page_id);
+  if (!guard) {
+    return INVALID_PAGE_ID;
+  }
+  TablePage *NewPage = reinterpret_cast<TablePage *>(guard.GetPage());
+  guard.SetDirty();
   NewPage->Init(new_page_id, last_page_id, log_manager, txn);
   NewPage->SetNextPageId(INVALID_PAGE_ID);
   return new_page_id;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
-  TablePage *Page = nullptr;
+page_id_t TableHeap::FindPageWithSpace(uint32_t tuple_size) {
+  uint8_t category = FreeSpaceMapLeafPage::NeededCategory(tuple_size);
+  // the root is write latched: a leaf whose bound is found too high gets it lowered.
+  WritePageGuard root_guard = buffer_pool_manager_->FetchPageWrite(free_space_map_page_id_);
+  auto root = root_guard.As<FreeSpaceMapRootPage>();
+  for (uint32_t i = root->FindLeaf(category, 0); i < FreeSpaceMapRootPage::MAX_LEAVES;
+       i = root->FindLeaf(category, i + 1)) {
+    ReadPageGuard leaf_guard = buffer_pool_manager_->FetchPageRead(root->GetLeafPageId(i));
+    auto leaf = leaf_guard.As<FreeSpaceMapLeafPage>();
+    uint32_t index = leaf->FindPage(category);
+    if (index < FreeSpaceMapLeafPage::LEAF_PAGES) {
+      return i * FreeSpaceMapLeafPage::LEAF_PAGES + index;
+    }
+    root_guard.AsMut<FreeSpaceMapRootPage>()->SetLeafMax(i, leaf->GetMaxCategory());
+  }
+  // the pages past the map are not recorded, the last page of the heap is tried before a page is appended. Its latch
+  // is taken once the root is released, the inserts latch a page before the root.
+  page_id_t last_page_id = root->GetLastPageId();
+  root_guard.Drop();
+  if (static_cast<uint32_t>(last_page_id) / FreeSpaceMapLeafPage::LEAF_PAGES < FreeSpaceMapRootPage::MAX_LEAVES) {
+    return INVALID_PAGE_ID;
+  }
+  ReadPageGuard last_guard = buffer_pool_manager_->FetchPageRead(last_page_id);
+  if (!last_guard || reinterpret_cast<TablePage *>(last_guard.GetPage())->GetFreeSpaceForTuple() < tuple_size) {
+    return INVALID_PAGE_ID;
+  }
+  return last_page_id;
+}
+
+page_id_t TableHeap::AppendPage(Transaction *txn) {
+  page_id_t last_page_id;
+  {
+    ReadPageGuard root_guard = buffer_pool_manager_->FetchPageRead(free_space_map_page_id_);
+    last_page_id = root_guard.As<FreeSpaceMapRootPage>()->GetLastPageId();
+  }
+  page_id_t new_page_id = AllocateNewPage(last_page_id, buffer_pool_manager_, txn, lock_manager_, log_manager_);
+  if (new_page_id == INVALID_PAGE_ID) {
+    return INVALID_PAGE_ID;
+  }
+  // the new page becomes the last one under the latch of the root, a concurrent append links its page after it.
+  page_id_t prev_page_id;
+  {
+    WritePageGuard root_guard = buffer_pool_manager_->FetchPageWrite(free_space_map_page_id_);
+    auto root = root_guard.AsMut<FreeSpaceMapRootPage>();
+    prev_page_id = root->GetLastPageId();
+    root->SetLastPageId(new_page_id);
+  }
+  {
+    WritePageGuard prev_guard = buffer_pool_manager_->FetchPageWrite(prev_page_id);
+    reinterpret_cast<TablePage *>(prev_guard.GetPage())->SetNextPageId(new_page_id);
+    prev_guard.SetDirty();
+  }
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(new_page_id);
+  auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+  if (prev_page_id != last_page_id) {
+    page->SetPrevPageId(prev_page_id);
+    guard.SetDirty();
+  }
+  RecordFreeSpace(page);
+  return new_page_id;
+}
+
+void TableHeap::RecordFreeSpace(TablePage *page) {
+  page_id_t page_id = page->GetTablePageId();
+  uint32_t leaf_index = page_id / FreeSpaceMapLeafPage::LEAF_PAGES;
+  if (free_space_map_page_id_ == INVALID_PAGE_ID || leaf_index >= FreeSpaceMapRootPage::MAX_LEAVES) {
+    return;
+  }
+  uint8_t category = FreeSpaceMapLeafPage::ToCategory(page->GetFreeSpaceForTuple());
+  WritePageGuard root_guard = buffer_pool_manager_->FetchPageWrite(free_space_map_page_id_);
+  page_id_t leaf_page_id = root_guard.As<FreeSpaceMapRootPage>()->GetLeafPageId(leaf_index);
+  if (leaf_page_id == INVALID_PAGE_ID) {
+    // the first page of the heap in this range of page ids.
+    BasicPageGuard leaf_guard = buffer_pool_manager_->NewPageGuarded(leaf_page_id);
+    if (!leaf_guard) {
+      return;
+    }
+    leaf_guard.AsMut<FreeSpaceMapLeafPage>()->Init();
+    root_guard.AsMut<FreeSpaceMapRootPage>()->SetLeafPageId(leaf_index, leaf_page_id);
+  }
+  WritePageGuard leaf_guard = buffer_pool_manager_->FetchPageWrite(leaf_page_id);
+  auto leaf = leaf_guard.As<FreeSpaceMapLeafPage>();
+  uint32_t index = page_id % FreeSpaceMapLeafPage::LEAF_PAGES;
+  if (leaf->GetCategory(index) != category) {
+    leaf_guard.AsMut<FreeSpaceMapLeafPage>()->SetCategory(index, category);
+  }
+  if (category > root_guard.As<FreeSpaceMapRootPage>()->GetLeafMax(leaf_index)) {
+    root_guard.AsMut<FreeSpaceMapRootPage>()->SetLeafMax(leaf_index, category);
+  }
+}
+
+TableIterator TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) {
   RowId row_id;
-  // Find Valid Page
+  // Find the first Page which holds a tuple, the iterator keeps it pinned
   for (page_id_t i = this->GetFirstPageId(); i != INVALID_PAGE_ID;) {
-    Page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(i));
-    bool state = Page->GetFirstTupleRid(&row_id);
-    buffer_pool_manager_->UnpinPage(Page->GetPageId(), false);
-    if (state == true) {
-      break;
+    BasicPageGuard guard = buffer_pool_manager_->FetchPageBasic(i, strategy);
+    auto Page = reinterpret_cast<TablePage *>(guard.GetPage());
+    if (Page->GetFirstTupleRid(&row_id)) {
+      // the scan is sequential, start to load the following pages. The read-ahead would take the frames from the
+      // replacer, a scan with its own ring reads its pages one at a time.
+      if (strategy == nullptr) {
+        buffer_pool_manager_->PrefetchPages(Page->GetNextPageId(), TABLE_READ_AHEAD_PAGES, TablePage::NextPageIdOf);
+      }
+      char *position = Page->GetData() + Page->position_calculate(row_id.GetSlotNum());
+      return TableIterator(row_id, position, buffer_pool_manager_, this->schema_, std::move(guard), strategy);
     }
-
     i = Page->GetNextPageId();
   }
-  // current Rid,current page tuple count
-
-  char *position = nullptr;
-  position = Page->GetData() + Page->position_calculate(0);
-  buffer_pool_manager_->UnpinPage(this->first_page_id_, false);
-  return TableIterator(row_id, position, buffer_pool_manager_, this->schema_, Page);
+  // the table is empty
+  return End();
 }
 
 TableIterator TableHeap::End() {
   RowId tmp;
   tmp.Set(INVALID_PAGE_ID, 0);
-  return TableIterator(tmp, nullptr, nullptr, nullptr, nullptr);
+  return TableIterator(tmp, nullptr, nullptr, nullptr, BasicPageGuard());
 }
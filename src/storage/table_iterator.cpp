@@ -2,69 +2,80 @@
 #include "common/macros.h"
 #include "storage/table_heap.h"
 
+TableIterator::TableIterator(const TableIterator &other) {
+  this->rowId_ = other.rowId_;
+  this->Position = other.Position;
+  this->buffer_pool_manager_ = other.buffer_pool_manager_;
+  this->schema = other.schema;
+  this->strategy_ = other.strategy_;
+  this->read_ahead_left_ = other.read_ahead_left_;
+  if (other.Page_pointer != nullptr) {
+    // the page is pinned by the other iterator, it is found in the same frame.
+    page_guard_ = buffer_pool_manager_->FetchPageBasic(other.page_guard_.GetPageId(), strategy_);
+  }
+  this->Page_pointer = reinterpret_cast<TablePage *>(page_guard_.GetPage());
+}
+
 TableIterator::~TableIterator() {}
 
 bool TableIterator::operator==(const TableIterator &itr) const { return this->rowId_ == itr.rowId_; }
 
 bool TableIterator::operator!=(const TableIterator &itr) const { return !(this->rowId_ == itr.rowId_); }
 
-const Row &TableIterator::operator*() {
-  void *mem = heap_->Allocate(sizeof(Row));
-  Row *row = new (mem) Row(this->rowId_);
-  row->DeserializeFrom(this->Position, this->schema);
-  return *row;
-}
+const Row &TableIterator::operator*() { return *(this->operator->()); }
 
 Row *TableIterator::operator->() {
-  void *mem = heap_->Allocate(sizeof(Row));
-  Row *row = new (mem) Row(this->rowId_);
-  row->DeserializeFrom(this->Position, this->schema);
-  return row;
+  if (row_ == nullptr) {
+    row_ = std::make_unique<Row>(this->rowId_);
+    row_->DeserializeFrom(this->Position, this->schema);
+  }
+  return row_.get();
+}
+
+RowView &TableIterator::View() {
+  if (!view_valid_) {
+    view_.Reset(this->Position, this->schema, this->rowId_);
+    view_valid_ = true;
+  }
+  return view_;
 }
 
 TableIterator &TableIterator::operator++() {
+  view_valid_ = false;
+  row_.reset();
   RowId next_rowId;
   if (this->Page_pointer->GetNextTupleRid(this->rowId_, &next_rowId)) {
     this->rowId_.Set(this->rowId_.GetPageId(), next_rowId.GetSlotNum());
     this->Position = this->Page_pointer->GetData() + this->Page_pointer->position_calculate(this->rowId_.GetSlotNum());
-  } else {
-    if (this->Page_pointer->GetNextPageId() == INVALID_PAGE_ID) {
-      this->rowId_.Set(next_rowId.GetPageId(), next_rowId.GetSlotNum());
+    return *this;
+  }
+  // go to the first tuple of the following pages, the current page is unpinned once the next one is pinned.
+  for (page_id_t next_page_id = this->Page_pointer->GetNextPageId(); next_page_id != INVALID_PAGE_ID;
+       next_page_id = this->Page_pointer->GetNextPageId()) {
+    page_guard_ = buffer_pool_manager_->FetchPageBasic(next_page_id, this->strategy_);
+    this->Page_pointer = reinterpret_cast<TablePage *>(page_guard_.GetPage());
+    // keep the read-ahead window in front of the scan. The window is moved once the scan is half way through it,
+    // not at every page: the pages still ahead are resident, a request per page would only walk them again.
+    if (this->strategy_ == nullptr && --read_ahead_left_ <= TABLE_READ_AHEAD_PAGES / 2) {
+      buffer_pool_manager_->PrefetchPages(this->Page_pointer->GetNextPageId(), TABLE_READ_AHEAD_PAGES,
+                                          TablePage::NextPageIdOf);
+      read_ahead_left_ = TABLE_READ_AHEAD_PAGES;
+    }
+    if (this->Page_pointer->GetFirstTupleRid(&this->rowId_)) {
+      this->Position = this->Page_pointer->GetData() + this->Page_pointer->position_calculate(this->rowId_.GetSlotNum());
       return *this;
-    } else {
-      auto Page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(this->Page_pointer->GetNextPageId()));
-      RowId first_rowId;
-      Page->GetFirstTupleRid(&first_rowId);
-      this->rowId_ = first_rowId;
-      this->Position = Page->GetData() + Page->position_calculate(this->rowId_.GetSlotNum());
-      this->Page_pointer = Page;
-      buffer_pool_manager_->UnpinPage(Page->GetPageId(), false);
     }
   }
-
+  // the end of the table, the last page is released.
+  this->rowId_.Set(INVALID_PAGE_ID, 0);
+  this->Position = nullptr;
+  this->Page_pointer = nullptr;
+  page_guard_.Drop();
   return *this;
 }
 
 TableIterator TableIterator::operator++(int) {
   TableIterator tmp(*this);
-  RowId next_rowId;
-  if (this->Page_pointer->GetNextTupleRid(this->rowId_, &next_rowId)) {
-    this->rowId_.Set(this->rowId_.GetPageId(), next_rowId.GetSlotNum());
-    this->Position = this->Page_pointer->GetData() + this->Page_pointer->position_calculate(this->rowId_.GetSlotNum());
-  } else {
-    if (this->Page_pointer->GetNextPageId() == INVALID_PAGE_ID) {
-      this->rowId_.Set(next_rowId.GetPageId(), next_rowId.GetSlotNum());
-      return TableIterator(*this);
-    } else {
-      auto Page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(this->Page_pointer->GetNextPageId()));
-      RowId first_rowId;
-      Page->GetFirstTupleRid(&first_rowId);
-      this->rowId_ = first_rowId;
-      this->Position = Page->GetData() + Page->position_calculate(this->rowId_.GetSlotNum());
-      this->Page_pointer = Page;
-      buffer_pool_manager_->UnpinPage(Page->GetPageId(), false);
-    }
-  }
-
-  return TableIterator(tmp);
+  ++(*this);
+  return tmp;
 }
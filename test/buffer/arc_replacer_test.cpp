@@ -0,0 +1,98 @@
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+#include "utils/replacer_trace.h"
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: load four pages, page 1 and page 2 are accessed again and move to T2.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    arc_replacer.OnLoad(frame_id, 100 + frame_id);
+    arc_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(4, arc_replacer.Size());
+  for (frame_id_t frame_id : {1, 2}) {
+    arc_replacer.Pin(frame_id);
+    arc_replacer.Unpin(frame_id);
+  }
+
+  // Scenario: the pages accessed once (T1) are evicted first, the least recently used first.
+  int value;
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  arc_replacer.OnLoad(value, 200);
+  arc_replacer.Unpin(value);
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(0, arc_replacer.GetTargetSize());
+
+  // Scenario: page 100 comes back while it is remembered in B1, the target size of T1 grows and the page goes to T2.
+  arc_replacer.OnLoad(value, 100);
+  arc_replacer.Unpin(value);
+  EXPECT_EQ(1, arc_replacer.GetTargetSize());
+
+  // Scenario: a pinned frame is never a victim.
+  arc_replacer.Pin(0);
+  EXPECT_EQ(3, arc_replacer.Size());
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_FALSE(arc_replacer.Victim(&value));
+
+  // Scenario: a dropped frame leaves the replacer.
+  arc_replacer.OnDrop(0);
+  arc_replacer.Unpin(0);
+  EXPECT_EQ(1, arc_replacer.Size());
+}
+
+TEST(ARCReplacerTest, TraceComparisonTest) {
+  const size_t pool_size = 64;
+  const page_id_t hot_pages = 48;
+  // point lookups mixed with full scans, a scan resistant policy keeps the hot set.
+  std::vector<page_id_t> mixed = MixedLookupScanTrace(hot_pages, 1000, 10, 200);
+  // a hot set which moves, a policy relying on old frequencies keeps the old hot set.
+  std::vector<page_id_t> shifting = ShiftingHotSetTrace(hot_pages, 1000, 20, 500);
+
+  auto hit_ratio = [&](ReplacerType type, const std::vector<page_id_t> &trace) {
+    Replacer *replacer;
+    switch (type) {
+      case kReplacerLRUK:
+        replacer = new LRUKReplacer(pool_size);
+        break;
+      case kReplacerClock:
+        replacer = new ClockReplacer(pool_size);
+        break;
+      case kReplacerARC:
+        replacer = new ARCReplacer(pool_size);
+        break;
+      default:
+        replacer = new LRUReplacer(pool_size);
+        break;
+    }
+    ReplacerTraceSimulator simulator(replacer, pool_size);
+    double ratio = simulator.Replay(trace);
+    delete replacer;
+    return ratio;
+  };
+
+  std::vector<ReplacerType> policies = {kReplacerLRU, kReplacerLRUK, kReplacerClock, kReplacerARC};
+  std::vector<double> mixed_ratios;
+  std::vector<double> shifting_ratios;
+  for (auto policy : policies) {
+    mixed_ratios.push_back(hit_ratio(policy, mixed));
+    shifting_ratios.push_back(hit_ratio(policy, shifting));
+  }
+  // ARC keeps the hot set during the scans like LRU-2, and follows a moving hot set like LRU.
+  EXPECT_GT(mixed_ratios[3], mixed_ratios[0] + 0.1);
+  EXPECT_GT(mixed_ratios[3], mixed_ratios[1] - 0.05);
+  EXPECT_GT(shifting_ratios[3], shifting_ratios[0] - 0.05);
+  EXPECT_GT(shifting_ratios[3], shifting_ratios[1] + 0.1);
+}
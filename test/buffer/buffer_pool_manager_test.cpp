@@ -1,6 +1,13 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <iostream>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -70,4 +77,662 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   delete bpm;
   delete disk_manager;
-}
\ No newline at end of file
+}
+
+TEST(BufferPoolManagerTest, ConcurrentHitPathTest) {
+  const std::string db_name = "bpm_concurrent_test.db";
+  const size_t buffer_pool_size = 16;
+  const page_id_t num_pages = 48;
+  const size_t num_threads = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // every page stores its own page id.
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: hits and misses with evictions from several threads never hand out a wrong page.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 rng(t);
+      // mostly a small hot set, sometimes the other pages to force replacements.
+      std::uniform_int_distribution<page_id_t> hot(0, 3);
+      std::uniform_int_distribution<page_id_t> all(0, num_pages - 1);
+      for (int i = 0; i < 20000; i++) {
+        page_id_t page_id = (i % 8 == 0) ? all(rng) : hot(rng);
+        Page *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData()));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, i % 16 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  // Scenario: a page can not be unpinned more times than it is pinned.
+  Page *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_FALSE(bpm->UnpinPage(0, false));
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, BackgroundFlusherTest) {
+  const std::string db_name = "bpm_flusher_test.db";
+  const size_t buffer_pool_size = 10;
+
+  for (auto replacer_type : {kReplacerLRU, kReplacerLRUK, kReplacerClock, kReplacerARC}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, replacer_type);
+
+    // every page stores its own page id.
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      page_id_t page_id;
+      Page *page = bpm->NewPage(page_id);
+      ASSERT_NE(nullptr, page);
+      memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+      page_ids.push_back(page_id);
+    }
+    // Scenario: pinned pages are never written by the flusher.
+    bpm->StartBackgroundFlusher(2, 5, buffer_pool_size, std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(0, bpm->GetDirtyPageCount());
+    for (auto page_id : page_ids) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+
+    // Scenario: the unpinned dirty pages are written back until the low watermark is reached.
+    for (int i = 0; i < 1000 && bpm->GetDirtyPageCount() > 2; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(2, bpm->GetDirtyPageCount());
+    bpm->StopBackgroundFlusher();
+
+    // the pages near the eviction end are clean and already on disk.
+    char data[PAGE_SIZE];
+    size_t written = 0;
+    for (auto page_id : page_ids) {
+      disk_manager->ReadPage(page_id, data);
+      written += *reinterpret_cast<page_id_t *>(data) == page_id ? 1 : 0;
+    }
+    EXPECT_EQ(buffer_pool_size - 2, written);
+
+    // Scenario: pages changed while the flusher is running are never lost.
+    bpm->StartBackgroundFlusher(0, 1, buffer_pool_size, std::chrono::milliseconds(1));
+    for (int round = 1; round <= 50; round++) {
+      for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+        page_id_t page_id;
+        if (i < buffer_pool_size) {
+          page_id = page_ids[i];
+        } else {
+          Page *page = bpm->NewPage(page_id);
+          ASSERT_NE(nullptr, page);
+          bpm->UnpinPage(page_id, false);
+          continue;
+        }
+        Page *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        memcpy(page->GetData() + sizeof(page_id_t), &round, sizeof(int));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      }
+    }
+    bpm->StopBackgroundFlusher();
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    delete bpm;
+    for (auto page_id : page_ids) {
+      disk_manager->ReadPage(page_id, data);
+      EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(data));
+      EXPECT_EQ(50, *reinterpret_cast<int *>(data + sizeof(page_id_t)));
+    }
+    delete disk_manager;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PrefetchPagesTest) {
+  const std::string db_name = "bpm_prefetch_test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_pages = 30;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // a chain of pages, the first 4 bytes of every page store the next page id.
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    page_id_t next_page_id = page_id + 1 < num_pages ? page_id + 1 : INVALID_PAGE_ID;
+    memcpy(page->GetData(), &next_page_id, sizeof(page_id_t));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  auto next_of = [](const char *page_data) { return *reinterpret_cast<const page_id_t *>(page_data); };
+
+  // Scenario: the pages of the chain are loaded in the background.
+  bpm->PrefetchPages(5, 4, next_of);
+  bpm->WaitForPrefetches();
+  // change the pages on disk, the pages loaded ahead are served from the buffer pool.
+  char garbage[PAGE_SIZE];
+  memset(garbage, 0x7f, PAGE_SIZE);
+  for (page_id_t page_id = 5; page_id < 10; page_id++) {
+    disk_manager->WritePage(page_id, garbage);
+  }
+  for (page_id_t page_id = 5; page_id < 9; page_id++) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id + 1, *reinterpret_cast<page_id_t *>(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  // only 4 pages are loaded.
+  Page *page = bpm->FetchPage(9);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0x7f7f7f7f, *reinterpret_cast<page_id_t *>(page->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(9, false));
+
+  // Scenario: the read-ahead stops at the end of the chain, and does not take the frames of pinned pages.
+  std::vector<page_id_t> pinned;
+  for (page_id_t page_id = 10; page_id < 18; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    pinned.push_back(page_id);
+  }
+  bpm->PrefetchPages(25, 100, next_of);
+  bpm->WaitForPrefetches();
+  for (auto page_id : pinned) {
+    page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id + 1, *reinterpret_cast<page_id_t *>(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, BufferAccessStrategyTest) {
+  const std::string db_name = "bpm_strategy_test.db";
+  const size_t buffer_pool_size = 20;
+  const page_id_t hot_pages = 10;
+  const page_id_t num_pages = 100;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // every page stores its own page id.
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // the working set
+  for (page_id_t page_id = 0; page_id < hot_pages; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a bulk read of all the other pages recycles the frames of its ring.
+  BufferAccessStrategy strategy(4);
+  for (page_id_t page_id = hot_pages; page_id < num_pages; page_id++) {
+    Page *page = bpm->FetchPage(page_id, &strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  // the working set is still in the buffer pool: change it on disk, the buffer pool still has the old data.
+  char garbage[PAGE_SIZE];
+  memset(garbage, 0x7f, PAGE_SIZE);
+  bpm->FlushAllPages();
+  for (page_id_t page_id = 0; page_id < hot_pages; page_id++) {
+    disk_manager->WritePage(page_id, garbage);
+  }
+  for (page_id_t page_id = 0; page_id < hot_pages; page_id++) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a bulk load through a ring, the pages written by the ring are on disk once their frames are recycled.
+  std::vector<page_id_t> loaded;
+  for (int i = 0; i < 20; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id, &strategy);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    loaded.push_back(page_id);
+  }
+  char data[PAGE_SIZE];
+  for (size_t i = 0; i + strategy.GetRingSize() < loaded.size(); i++) {
+    disk_manager->ReadPage(loaded[i], data);
+    EXPECT_EQ(loaded[i], *reinterpret_cast<page_id_t *>(data));
+  }
+  // the working set is still there.
+  for (page_id_t page_id = 0; page_id < hot_pages; page_id++) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, WarmRestartTest) {
+  const std::string db_name = "bpm_warm_test.db";
+  const std::string warm_file_name = db_name + ".warm";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_pages = 30;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  // every page stores its own page id.
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // the hot pages: 0, 3, 6, ..., 27
+  std::vector<page_id_t> hot_pages;
+  for (page_id_t page_id = 0; page_id < num_pages; page_id += 3) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    hot_pages.push_back(page_id);
+  }
+  EXPECT_TRUE(bpm->SaveResidentPages(warm_file_name));
+  delete bpm;
+
+  for (bool background : {false, true}) {
+    // a clean restart, then the data on disk is changed behind the buffer pool: the hot pages are served from memory.
+    bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    EXPECT_EQ(hot_pages.size(), bpm->LoadResidentPages(warm_file_name, background));
+    // Scenario: the sidecar file is removed once read.
+    EXPECT_EQ(0, bpm->LoadResidentPages(warm_file_name, background));
+    bpm->WaitForWarmUp();
+    char garbage[PAGE_SIZE];
+    memset(garbage, 0x7f, PAGE_SIZE);
+    char data[PAGE_SIZE];
+    for (auto page_id : hot_pages) {
+      disk_manager->ReadPage(page_id, data);
+      disk_manager->WritePage(page_id, garbage);
+    }
+    for (auto page_id : hot_pages) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData()));
+      // written back with its original data.
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    EXPECT_TRUE(bpm->SaveResidentPages(warm_file_name));
+    delete bpm;
+  }
+  remove(warm_file_name.c_str());
+
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, StatsTest) {
+  const std::string db_name = "bpm_stats_test.db";
+  const size_t buffer_pool_size = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the pool with dirty pages, one more NewPage fails while all the frames are pinned.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.pool_size_);
+  EXPECT_EQ(buffer_pool_size, stats.new_pages_);
+  EXPECT_EQ(1, stats.pin_wait_failures_);
+  EXPECT_EQ(buffer_pool_size, stats.dirty_pages_);
+
+  // Scenario: two hits, then a new page replaces page 0, which is written back first.
+  for (page_id_t i : {1, 2}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  stats = bpm->GetStats();
+  EXPECT_EQ(2, stats.fetch_hits_);
+  EXPECT_EQ(0, stats.fetch_misses_);
+  EXPECT_EQ(1, stats.evictions_);
+  EXPECT_EQ(1, stats.dirty_write_backs_);
+  EXPECT_EQ(buffer_pool_size - 1, stats.dirty_pages_);
+
+  // Scenario: page 0 is read back (a miss), then deleted.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_TRUE(bpm->DeletePage(0));
+  bpm->FlushAllPages();
+  stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.fetch_misses_);
+  EXPECT_EQ(1, stats.deleted_pages_);
+  EXPECT_EQ(0, stats.dirty_pages_);
+  EXPECT_DOUBLE_EQ(2.0 / 3, stats.HitRatio());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "bpm_resize_test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t max_pool_size = 200;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, kReplacerLRU, max_pool_size);
+
+  // Scenario: a full pool grows, the new frames are free and the pinned pages stay where they are.
+  std::vector<Page *> pages;
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    pages.push_back(bpm->NewPage(page_id));
+    ASSERT_NE(nullptr, pages.back());
+    snprintf(pages.back()->GetData(), PAGE_SIZE, "page %d", page_id);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  ASSERT_TRUE(bpm->Resize(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (size_t i = buffer_pool_size; i < max_pool_size; i++) {
+    pages.push_back(bpm->NewPage(page_id));
+    ASSERT_NE(nullptr, pages.back());
+    snprintf(pages.back()->GetData(), PAGE_SIZE, "page %d", page_id);
+  }
+  EXPECT_EQ(0, strcmp(pages[0]->GetData(), "page 0"));
+  EXPECT_FALSE(bpm->Resize(max_pool_size + FrameArray::FRAME_CHUNK_SIZE));
+
+  // Scenario: shrinking is refused while a page to drop is pinned.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(max_pool_size) - 1; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+  EXPECT_FALSE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  EXPECT_TRUE(bpm->UnpinPage(max_pool_size - 1, true));
+
+  // Scenario: the pool shrinks, the dropped pages are written back and read again on demand.
+  ASSERT_TRUE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  // the pages left in the pool are still dirty, the others have been written back.
+  EXPECT_EQ(buffer_pool_size, bpm->GetDirtyPageCount());
+  for (page_id_t i = 0; i < static_cast<page_id_t>(max_pool_size); i++) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(static_cast<page_id_t>(i)));
+  }
+  page_id_t fetched = static_cast<page_id_t>(buffer_pool_size);
+  EXPECT_EQ(nullptr, bpm->FetchPage(fetched));
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(static_cast<page_id_t>(i), false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ConcurrentResizeTest) {
+  const std::string db_name = "bpm_concurrent_resize_test.db";
+  const size_t num_pages = 100;
+  const size_t num_threads = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(num_pages, disk_manager, kReplacerClock, num_pages);
+  page_id_t page_id;
+  for (size_t i = 0; i < num_pages; i++) {
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    *reinterpret_cast<page_id_t *>(page->GetData()) = page_id;
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: the readers keep fetching pages while the pool shrinks and grows under them.
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> wrong_pages{0};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      while (!stop.load()) {
+        auto id = static_cast<page_id_t>(rng() % num_pages);
+        Page *page = bpm->FetchPage(id);
+        if (page == nullptr) {
+          continue;
+        }
+        if (*reinterpret_cast<page_id_t *>(page->GetData()) != id) {
+          wrong_pages++;
+        }
+        bpm->UnpinPage(id, rng() % 4 == 0);
+      }
+    });
+  }
+  size_t resized = 0;
+  for (size_t round = 0; round < 200; round++) {
+    resized += bpm->Resize(round % 2 == 0 ? 2 * num_threads : num_pages) ? 1 : 0;
+  }
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, wrong_pages.load());
+  EXPECT_GT(resized, 0);
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ReadOnlyMappedTest) {
+  const std::string db_name = "bpm_mmap_test.db";
+  const size_t buffer_pool_size = 4;
+  const page_id_t num_pages = 20;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  // every page stores its own page id.
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: the pages of a read only db file are the pages of the mapping, they are not copied.
+  disk_manager = new DiskManager(db_name, kDiskIOMmapReadOnly);
+  EXPECT_TRUE(disk_manager->IsReadOnly());
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  for (int round = 0; round < 2; round++) {
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(disk_manager->GetMappedPage(page_id), page->GetData());
+      EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  EXPECT_FALSE(disk_manager->IsPageFree(num_pages - 1));
+  EXPECT_TRUE(disk_manager->IsPageFree(num_pages));
+
+  // Scenario: nothing can be allocated, deleted or written. The mapping is read only, a page is not even latched for
+  // a write, and a dirty unpin fails.
+  EXPECT_TRUE(bpm->IsReadOnly());
+  EXPECT_FALSE(bpm->FetchPageWrite(1));
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_FALSE(bpm->UnpinPage(1, true));
+  bpm->FlushAllPages();
+  EXPECT_EQ(0, bpm->GetDirtyPageCount());
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  EXPECT_FALSE(bpm->DeletePage(0));
+  EXPECT_TRUE(bpm->FlushPage(num_pages - 1));
+  EXPECT_EQ(INVALID_PAGE_ID, disk_manager->AllocatePage());
+
+  // Scenario: a frame which held a mapped page gets its own memory back for a new page.
+  delete bpm;
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(nullptr, disk_manager->GetMappedPage(i));
+    EXPECT_EQ(i, *reinterpret_cast<page_id_t *>(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ShutdownFlushTest) {
+  const std::string db_name = "bpm_shutdown_test.db";
+  const size_t buffer_pool_size = 256;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  bpm->FlushAllPages();
+  // the pool is full of dirty pages, each stores its page id, dirtied in no particular order.
+  std::shuffle(page_ids.begin(), page_ids.end(), std::default_random_engine(0));
+  for (auto page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetDirtyPageCount());
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: the pages written in one batch by the shutdown are all on disk.
+  disk_manager = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(data));
+  }
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+// Compares a flush a page at a time with the batched flush of the shutdown, run with
+// --gtest_also_run_disabled_tests --gtest_filter=*ShutdownFlushBenchmark.
+TEST(BufferPoolManagerTest, DISABLED_ShutdownFlushBenchmark) {
+  const std::string db_name = "bpm_shutdown_test.db";
+  const size_t buffer_pool_size = 8192;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  // the pool is full of dirty pages, each stores its page id and the round which wrote it.
+  std::vector<page_id_t> page_ids;
+  auto dirty_all = [&](int round) {
+    for (auto page_id : page_ids) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+      memcpy(page->GetData() + sizeof(page_id_t), &round, sizeof(int));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  };
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  bpm->FlushAllPages();
+  std::shuffle(page_ids.begin(), page_ids.end(), std::default_random_engine(0));
+
+  // one synchronous write per page in no particular order, as a walk over the page table does.
+  dirty_all(1);
+  auto start = std::chrono::steady_clock::now();
+  for (auto page_id : page_ids) {
+    EXPECT_TRUE(bpm->FlushPage(page_id));
+  }
+  disk_manager->Sync();
+  std::chrono::duration<double, std::milli> page_at_a_time = std::chrono::steady_clock::now() - start;
+
+  // the shutdown: the dirty pages are written in one sorted batch of vectored writes and synced once.
+  dirty_all(2);
+  EXPECT_EQ(buffer_pool_size, bpm->GetDirtyPageCount());
+  start = std::chrono::steady_clock::now();
+  delete bpm;
+  std::chrono::duration<double, std::milli> batched = std::chrono::steady_clock::now() - start;
+  std::cout << "flush of " << buffer_pool_size << " dirty pages: " << page_at_a_time.count()
+            << " ms a page at a time, " << batched.count() << " ms batched" << std::endl;
+  delete disk_manager;
+
+  // Scenario: the pages written by the shutdown are all on disk.
+  disk_manager = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(data));
+    EXPECT_EQ(2, *reinterpret_cast<int *>(data + sizeof(page_id_t)));
+  }
+  delete disk_manager;
+  remove(db_name.c_str());
+}
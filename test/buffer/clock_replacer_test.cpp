@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+TEST(ClockReplacerTest, SampleTest) {
+  ClockReplacer clock_replacer(7);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer.
+  clock_replacer.Unpin(1);
+  clock_replacer.Unpin(2);
+  clock_replacer.Unpin(3);
+  clock_replacer.Unpin(4);
+  clock_replacer.Unpin(5);
+  clock_replacer.Unpin(6);
+  clock_replacer.Unpin(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // Scenario: get three victims from the clock.
+  int value;
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: pin elements in the replacer.
+  // Note that 3 has already been victimized, so pinning 3 should have no effect.
+  clock_replacer.Pin(3);
+  clock_replacer.Pin(4);
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
+  clock_replacer.Unpin(4);
+
+  // Scenario: continue looking for victims. We expect these victims.
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+/**
+ * Unpin all the frames of order, pin half of them, unpin them again, then victimize all.
+ * @return the number of victims
+ */
+static size_t UnpinPinVictimRound(Replacer *replacer, const std::vector<frame_id_t> &order) {
+  for (auto frame_id : order) {
+    replacer->Unpin(frame_id);
+  }
+  for (size_t i = 0; i < order.size(); i += 2) {
+    replacer->Pin(order[i]);
+  }
+  for (size_t i = 0; i < order.size(); i += 2) {
+    replacer->Unpin(order[i]);
+  }
+  size_t victims = 0;
+  frame_id_t frame_id;
+  while (replacer->Victim(&frame_id)) {
+    victims++;
+  }
+  return victims;
+}
+
+static std::vector<frame_id_t> ShuffledFrames(size_t num_frames) {
+  std::vector<frame_id_t> order(num_frames);
+  for (size_t i = 0; i < num_frames; i++) {
+    order[i] = static_cast<frame_id_t>(i);
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(0));
+  return order;
+}
+
+TEST(ClockReplacerTest, PinUnpinVictimTest) {
+  const size_t num_frames = 1024;
+  std::vector<frame_id_t> order = ShuffledFrames(num_frames);
+  ClockReplacer clock(num_frames);
+
+  // Scenario: the frames pinned and unpinned again are all victimized, each of them once.
+  for (size_t r = 0; r < 3; r++) {
+    EXPECT_EQ(num_frames, UnpinPinVictimRound(&clock, order));
+    EXPECT_EQ(0, clock.Size());
+  }
+}
+
+// Compares the cost of the LRUReplacer and the ClockReplacer calls, run with
+// --gtest_also_run_disabled_tests --gtest_filter=*MicroBenchmark.
+TEST(ClockReplacerTest, DISABLED_MicroBenchmark) {
+  const size_t num_frames = 1024;
+  const size_t rounds = 200;
+  std::vector<frame_id_t> order = ShuffledFrames(num_frames);
+
+  auto run = [&](Replacer *replacer) {
+    auto start = std::chrono::steady_clock::now();
+    size_t victims = 0;
+    for (size_t r = 0; r < rounds; r++) {
+      victims += UnpinPinVictimRound(replacer, order);
+    }
+    EXPECT_EQ(rounds * num_frames, victims);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    // each round does 2.5 * num_frames Pin/Unpin and num_frames Victim calls.
+    return elapsed.count() / (rounds * num_frames * 3.5);
+  };
+
+  LRUReplacer lru(num_frames);
+  ClockReplacer clock(num_frames);
+  double lru_ns = run(&lru);
+  double clock_ns = run(&clock);
+  std::cout << "average cost per Victim/Pin/Unpin call: LRUReplacer " << lru_ns << " ns, ClockReplacer " << clock_ns
+            << " ns" << std::endl;
+}
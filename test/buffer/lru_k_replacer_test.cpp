@@ -0,0 +1,85 @@
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+#include "utils/replacer_trace.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer. Each of them has one recorded access.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Unpin(6);
+  // 1 is already evictable, no access is recorded.
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: access 1 again. 1 now has two accesses, its backward 2-distance is no longer infinite.
+  lru_k_replacer.Pin(1);
+  EXPECT_EQ(5, lru_k_replacer.Size());
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with a single access are evicted first, oldest first.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+
+  // Scenario: access 3 again, it is now the frame with the smallest backward 2-distance.
+  lru_k_replacer.Pin(3);
+  EXPECT_EQ(4, lru_k_replacer.Size());
+  lru_k_replacer.Unpin(3);
+
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+
+  // Scenario: a victimized frame starts with an empty history.
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(2);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const size_t pool_size = 64;
+  const page_id_t hot_pages = 48;
+  const page_id_t scan_pages = 1000;
+  // warm up with point lookups only, then mix them with full scans.
+  std::vector<page_id_t> warm_up = MixedLookupScanTrace(hot_pages, 0, 1, 1000);
+  std::vector<page_id_t> mixed = MixedLookupScanTrace(hot_pages, scan_pages, 10, 200);
+  // only the point lookups of the mixed workload are measured.
+  auto lookup_hit_ratio = [&](Replacer *replacer) {
+    ReplacerTraceSimulator simulator(replacer, pool_size);
+    simulator.Replay(warm_up);
+    size_t hits = 0, lookups = 0;
+    for (auto page_id : mixed) {
+      bool hit = simulator.Access(page_id);
+      if (page_id < hot_pages) {
+        hits += hit ? 1 : 0;
+        lookups++;
+      }
+    }
+    return static_cast<double>(hits) / lookups;
+  };
+
+  LRUReplacer lru(pool_size);
+  LRUKReplacer lru_k(pool_size, 2);
+  double lru_ratio = lookup_hit_ratio(&lru);
+  double lru_k_ratio = lookup_hit_ratio(&lru_k);
+  // the scans flush the hot set out of the LRU pool, the LRU-K pool keeps it.
+  EXPECT_LT(lru_ratio, 0.5);
+  EXPECT_GT(lru_k_ratio, 0.9);
+}
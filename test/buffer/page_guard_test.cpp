@@ -0,0 +1,96 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+TEST(PageGuardTest, SampleTest) {
+  const std::string db_name = "page_guard_test.db";
+  const size_t buffer_pool_size = 5;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: a new page is unpinned when its guard goes out of scope, as dirty if written through AsMut.
+  page_id_t page_id;
+  {
+    BasicPageGuard guard = bpm->NewPageGuarded(page_id);
+    ASSERT_TRUE(static_cast<bool>(guard));
+    EXPECT_EQ(page_id, guard.GetPageId());
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+    snprintf(guard.AsMut<char>(), PAGE_SIZE, "Hello");
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  EXPECT_EQ(1, bpm->GetDirtyPageCount());
+
+  // Scenario: a move hands the pin over, the page is unpinned once.
+  {
+    BasicPageGuard guard = bpm->FetchPageBasic(page_id);
+    Page *page = guard.GetPage();
+    BasicPageGuard other(std::move(guard));
+    EXPECT_FALSE(static_cast<bool>(guard));
+    EXPECT_EQ(page, other.GetPage());
+    EXPECT_EQ(1, page->GetPinCount());
+    BasicPageGuard assigned;
+    assigned = std::move(other);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(assigned.GetData(), "Hello"));
+    assigned.Drop();
+    EXPECT_EQ(0, page->GetPinCount());
+    assigned.Drop();
+    EXPECT_EQ(0, page->GetPinCount());
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  // Scenario: assigning to a guard unpins the page it held.
+  page_id_t other_page_id;
+  bpm->NewPageGuarded(other_page_id);
+  {
+    BasicPageGuard guard = bpm->FetchPageBasic(page_id);
+    Page *page = guard.GetPage();
+    guard = bpm->FetchPageBasic(other_page_id);
+    EXPECT_EQ(0, page->GetPinCount());
+    EXPECT_EQ(other_page_id, guard.GetPageId());
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  // Scenario: several readers share the page, the latches are released before the unpins.
+  {
+    ReadPageGuard reader = bpm->FetchPageRead(page_id);
+    ReadPageGuard other_reader = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, reader.GetPage()->GetPinCount());
+    EXPECT_EQ(0, strcmp(other_reader.GetData(), "Hello"));
+    ReadPageGuard moved(std::move(reader));
+    EXPECT_FALSE(static_cast<bool>(reader));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  {
+    WritePageGuard writer = bpm->FetchPageWrite(page_id);
+    snprintf(writer.AsMut<char>(), PAGE_SIZE, "World");
+  }
+  {
+    ReadPageGuard reader = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(0, strcmp(reader.GetData(), "World"));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  // Scenario: a fetch which fails gives an empty guard.
+  std::vector<BasicPageGuard> guards;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t temp_page_id;
+    guards.push_back(bpm->NewPageGuarded(temp_page_id));
+    ASSERT_TRUE(static_cast<bool>(guards.back()));
+  }
+  EXPECT_FALSE(static_cast<bool>(bpm->FetchPageBasic(page_id)));
+  guards.clear();
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,289 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/instance.h"
+#include "gtest/gtest.h"
+
+TEST(ParallelBufferPoolManagerTest, BinaryDataTest) {
+  const std::string db_name = "pbpm_test.db";
+  const size_t num_instances = 4;
+  const size_t instance_pool_size = 5;
+  const size_t buffer_pool_size = num_instances * instance_pool_size;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, instance_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  char random_binary_data[PAGE_SIZE];
+  std::random_device r;
+  std::default_random_engine rng(r());
+  std::uniform_int_distribution<char> uniform_dist(0);
+  for (char &i : random_binary_data) {
+    i = uniform_dist(rng);
+  }
+  std::memcpy(page0->GetData(), random_binary_data, PAGE_SIZE);
+
+  // Scenario: consecutive page ids are spread over the instances, so the whole pool can be filled.
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(page_id_temp));
+    EXPECT_EQ(i, page_id_temp);
+  }
+
+  // Scenario: all frames are pinned, the allocated page id is given back when no frame is found.
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+    EXPECT_TRUE(bpm->IsPageFree(buffer_pool_size));
+  }
+
+  // Scenario: unpin every page of instance 0, new pages of instance 0 can be created again.
+  for (size_t i = 0; i < buffer_pool_size; i += num_instances) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+  EXPECT_NE(nullptr, bpm->NewPage(page_id_temp));
+  EXPECT_EQ(buffer_pool_size, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: we should be able to fetch the data we wrote a while ago.
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_FALSE(bpm->CheckAllUnpinned());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    bpm->UnpinPage(i, false);
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(ParallelBufferPoolManagerTest, ConcurrentNewFetchTest) {
+  const std::string db_name = "pbpm_concurrent_test.db";
+  const size_t num_threads = 4;
+  const size_t pages_per_thread = 50;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(4, 16, disk_manager);
+
+  std::vector<std::vector<page_id_t>> created(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        Page *page = bpm->NewPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+        bpm->UnpinPage(page_id, true);
+        created[t].push_back(page_id);
+      }
+      for (auto page_id : created[t]) {
+        Page *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData()));
+        bpm->UnpinPage(page_id, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+/**
+ * Fetch and unpin random pages of the working set from num_threads threads.
+ * @return the number of fetches which found no frame
+ */
+static size_t FetchUnpinConcurrently(BufferPoolManager *bpm, size_t num_threads, size_t ops_per_thread,
+                                     page_id_t working_set) {
+  std::atomic<size_t> failed{0};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 rng(t);
+      std::uniform_int_distribution<page_id_t> dist(0, working_set - 1);
+      for (size_t i = 0; i < ops_per_thread; i++) {
+        page_id_t page_id = dist(rng);
+        Page *page = bpm->FetchPage(page_id);
+        if (page != nullptr) {
+          bpm->UnpinPage(page_id, false);
+        } else {
+          failed++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return failed;
+}
+
+static void PrepareWorkingSet(BufferPoolManager *bpm, page_id_t working_set) {
+  for (page_id_t i = 0; i < working_set; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    bpm->UnpinPage(page_id, true);
+  }
+}
+
+TEST(ParallelBufferPoolManagerTest, ConcurrentFetchTest) {
+  const std::string db_name = "pbpm_concurrent_test.db";
+  const page_id_t working_set = 256;
+
+  // Scenario: the working set fits in the pool, every fetch of every thread finds its page.
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *parallel = new ParallelBufferPoolManager(8, 512 / 8, disk_manager);
+  PrepareWorkingSet(parallel, working_set);
+  EXPECT_EQ(0, FetchUnpinConcurrently(parallel, 4, 5000, working_set));
+  EXPECT_TRUE(parallel->CheckAllUnpinned());
+  delete parallel;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+// Compares the fetch/unpin throughput of one buffer pool and of 8 instances, run with
+// --gtest_also_run_disabled_tests --gtest_filter=*ThroughputBenchmark.
+TEST(ParallelBufferPoolManagerTest, DISABLED_ThroughputBenchmark) {
+  const std::string db_name = "pbpm_bench_test.db";
+  const size_t num_threads = 4;
+  const size_t ops_per_thread = 100000;
+  const size_t total_frames = 512;
+  const page_id_t working_set = 256;
+
+  auto run = [&](BufferPoolManager *bpm) {
+    auto start = std::chrono::steady_clock::now();
+    FetchUnpinConcurrently(bpm, num_threads, ops_per_thread, working_set);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return num_threads * ops_per_thread / elapsed.count();
+  };
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *single = new BufferPoolManager(total_frames, disk_manager);
+  PrepareWorkingSet(single, working_set);
+  double single_ops = run(single);
+  delete single;
+  delete disk_manager;
+  remove(db_name.c_str());
+
+  disk_manager = new DiskManager(db_name);
+  auto *parallel = new ParallelBufferPoolManager(8, total_frames / 8, disk_manager);
+  PrepareWorkingSet(parallel, working_set);
+  double parallel_ops = run(parallel);
+  delete parallel;
+  delete disk_manager;
+  remove(db_name.c_str());
+
+  std::cout << num_threads << " threads fetch/unpin throughput: BufferPoolManager " << single_ops
+            << " ops/s, ParallelBufferPoolManager(8) " << parallel_ops << " ops/s" << std::endl;
+}
+
+TEST(ParallelBufferPoolManagerTest, WarmRestartTest) {
+  const std::string db_name = "pbpm_warm_test.db";
+  const std::string warm_file_name = db_name + ".warm";
+  const size_t num_instances = 4;
+  const size_t instance_pool_size = 5;
+  const page_id_t num_pages = 60;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, instance_pool_size, disk_manager);
+  // every page stores its own page id.
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // the hot pages: 0, 3, 6, ..., 57, spread over all the instances.
+  std::vector<page_id_t> hot_pages;
+  for (page_id_t page_id = 0; page_id < num_pages; page_id += 3) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    hot_pages.push_back(page_id);
+  }
+  EXPECT_TRUE(bpm->SaveResidentPages(warm_file_name));
+  delete bpm;
+
+  for (bool background : {false, true}) {
+    // Scenario: every instance loads its own hot pages, they are served from memory after the data on disk changed.
+    bpm = new ParallelBufferPoolManager(num_instances, instance_pool_size, disk_manager);
+    EXPECT_EQ(hot_pages.size(), bpm->LoadResidentPages(warm_file_name, background));
+    bpm->WaitForWarmUp();
+    char garbage[PAGE_SIZE];
+    memset(garbage, 0x7f, PAGE_SIZE);
+    for (auto page_id : hot_pages) {
+      disk_manager->WritePage(page_id, garbage);
+    }
+    for (auto page_id : hot_pages) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData()));
+      // written back with its original data.
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    EXPECT_TRUE(bpm->SaveResidentPages(warm_file_name));
+    delete bpm;
+  }
+  remove(warm_file_name.c_str());
+
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(ParallelBufferPoolManagerTest, EngineReopenTest) {
+  const std::string db_name = "pbpm_engine_test.db";
+  const uint32_t num_instances = 4;
+
+  // Scenario: a database with several buffer pool instances is reopened, the warm restart loads its pages.
+  { DBStorageEngine engine(db_name, true, DEFAULT_BUFFER_POOL_SIZE, num_instances); }
+  {
+    DBStorageEngine engine(db_name, false, DEFAULT_BUFFER_POOL_SIZE, num_instances);
+    engine.bpm_->WaitForWarmUp();
+    EXPECT_FALSE(engine.bpm_->IsPageFree(CATALOG_META_PAGE_ID));
+  }
+  remove(db_name.c_str());
+  remove((db_name + ".warm").c_str());
+}
+
+TEST(ParallelBufferPoolManagerTest, MoreInstancesThanFramesTest) {
+  const std::string db_name = "pbpm_instances_test.db";
+
+  // Scenario: the instances are limited to the number of frames, none of them is left without a frame.
+  {
+    DBStorageEngine engine(db_name, true, 4, 16);
+    EXPECT_EQ(4, engine.bpm_->GetPoolSize());
+    page_id_t page_id;
+    for (int i = 0; i < 4; i++) {
+      ASSERT_NE(nullptr, engine.bpm_->NewPage(page_id));
+      EXPECT_TRUE(engine.bpm_->UnpinPage(page_id, true));
+    }
+  }
+  remove(db_name.c_str());
+  remove((db_name + ".warm").c_str());
+}
@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "buffer/shared_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+TEST(SharedBufferPoolManagerTest, SeparateDatabasesTest) {
+  const std::string db_name_a = "sbpm_test_a.db";
+  const std::string db_name_b = "sbpm_test_b.db";
+  const size_t pool_size = 10;
+
+  remove(db_name_a.c_str());
+  remove(db_name_b.c_str());
+  auto *disk_manager_a = new DiskManager(db_name_a);
+  auto *disk_manager_b = new DiskManager(db_name_b);
+  auto *pool = new BufferPoolManager(pool_size, nullptr);
+  auto *bpm_a = new SharedBufferPoolManager(pool, disk_manager_a);
+  auto *bpm_b = new SharedBufferPoolManager(pool, disk_manager_b);
+  EXPECT_EQ(pool_size, bpm_a->GetPoolSize());
+
+  // Scenario: both databases allocate their own page 0, the pages are kept apart.
+  page_id_t page_id_a;
+  page_id_t page_id_b;
+  Page *page_a = bpm_a->NewPage(page_id_a);
+  Page *page_b = bpm_b->NewPage(page_id_b);
+  ASSERT_NE(nullptr, page_a);
+  ASSERT_NE(nullptr, page_b);
+  EXPECT_EQ(0, page_id_a);
+  EXPECT_EQ(0, page_id_b);
+  EXPECT_NE(page_a, page_b);
+  snprintf(page_a->GetData(), PAGE_SIZE, "database a");
+  snprintf(page_b->GetData(), PAGE_SIZE, "database b");
+  EXPECT_TRUE(bpm_a->UnpinPage(page_id_a, true));
+  EXPECT_TRUE(bpm_b->UnpinPage(page_id_b, true));
+  EXPECT_EQ(2, bpm_a->GetDirtyPageCount());
+
+  // Scenario: a busy database takes all the frames, the idle one gives its page back to disk.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm_a->NewPage(page_id));
+    page_ids.push_back(page_id);
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm_b->NewPage(page_id));
+  EXPECT_TRUE(bpm_b->CheckAllUnpinned());
+  EXPECT_FALSE(bpm_a->CheckAllUnpinned());
+  for (auto id : page_ids) {
+    EXPECT_TRUE(bpm_a->UnpinPage(id, false));
+  }
+
+  // Scenario: the pages are read back from the file of their own database.
+  page_b = bpm_b->FetchPage(0);
+  ASSERT_NE(nullptr, page_b);
+  EXPECT_EQ(0, strcmp(page_b->GetData(), "database b"));
+  page_a = bpm_a->FetchPage(0);
+  ASSERT_NE(nullptr, page_a);
+  EXPECT_EQ(0, strcmp(page_a->GetData(), "database a"));
+  EXPECT_TRUE(bpm_a->UnpinPage(0, false));
+  EXPECT_TRUE(bpm_b->UnpinPage(0, false));
+
+  // Scenario: closing a database writes its dirty pages back and gives all its frames to the other one.
+  page_b = bpm_b->FetchPage(0);
+  ASSERT_NE(nullptr, page_b);
+  snprintf(page_b->GetData(), PAGE_SIZE, "database b changed");
+  EXPECT_TRUE(bpm_b->UnpinPage(0, true));
+  delete bpm_b;
+  EXPECT_EQ(0, bpm_a->GetDirtyPageCount());
+  char data[PAGE_SIZE];
+  disk_manager_b->ReadPage(0, data);
+  EXPECT_EQ(0, strcmp(data, "database b changed"));
+  std::vector<Page *> pages;
+  for (size_t i = 0; i < pool_size; i++) {
+    pages.push_back(bpm_a->NewPage(page_id));
+    ASSERT_NE(nullptr, pages.back());
+  }
+  for (auto page : pages) {
+    EXPECT_TRUE(bpm_a->UnpinPage(page->GetPageId(), false));
+  }
+
+  delete bpm_a;
+  delete pool;
+  disk_manager_a->Close();
+  disk_manager_b->Close();
+  delete disk_manager_a;
+  delete disk_manager_b;
+  remove(db_name_a.c_str());
+  remove(db_name_b.c_str());
+}
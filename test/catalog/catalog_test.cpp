@@ -66,6 +66,12 @@ TEST(CatalogTest, CatalogTableTest) {
   ASSERT_EQ(DB_TABLE_NOT_EXIST, catalog_02->GetTable("table-2", table_info_03));
   ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("table-1", table_info_03));
   delete db_02;
+  /** Stage 3: Testing catalog loading from a read only db file */
+  auto db_03 = new DBStorageEngine(db_file_name, true, DEFAULT_BUFFER_POOL_SIZE, DEFAULT_BUFFER_POOL_INSTANCES, true);
+  auto &catalog_03 = db_03->catalog_mgr_;
+  ASSERT_TRUE(db_03->disk_mgr_->IsReadOnly());
+  ASSERT_EQ(DB_SUCCESS, catalog_03->GetTable("table-1", table_info_03));
+  delete db_03;
 }
 
 TEST(CatalogTest, CatalogIndexTest) {
@@ -0,0 +1,115 @@
+#ifndef MINISQL_REPLACER_TRACE_H
+#define MINISQL_REPLACER_TRACE_H
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+/**
+ * Replays a page access trace against a replacer the same way BufferPoolManager drives it: a miss takes a frame from
+ * the free list first and then from the replacer, every access pins the frame and unpins it right after.
+ */
+class ReplacerTraceSimulator {
+public:
+  ReplacerTraceSimulator(Replacer *replacer, size_t pool_size) : replacer_(replacer) {
+    for (size_t i = 0; i < pool_size; i++) {
+      free_list_.emplace_back(i);
+    }
+  }
+
+  /**
+   * @return true if the page is resident (a buffer pool hit)
+   */
+  bool Access(page_id_t page_id) {
+    bool hit = true;
+    frame_id_t frame_id;
+    auto search = page_table_.find(page_id);
+    if (search != page_table_.end()) {
+      frame_id = search->second;
+    } else {
+      hit = false;
+      if (!free_list_.empty()) {
+        frame_id = free_list_.front();
+        free_list_.pop_front();
+      } else if (replacer_->Victim(&frame_id)) {
+        page_table_.erase(frame_page_[frame_id]);
+      } else {
+        return false;
+      }
+      page_table_[page_id] = frame_id;
+      frame_page_[frame_id] = page_id;
+      replacer_->OnLoad(frame_id, static_cast<uint64_t>(page_id));
+    }
+    replacer_->Pin(frame_id);
+    replacer_->Unpin(frame_id);
+    hits_ += hit ? 1 : 0;
+    accesses_++;
+    return hit;
+  }
+
+  /**
+   * Replay the whole trace.
+   * @return the hit ratio of the trace
+   */
+  double Replay(const std::vector<page_id_t> &trace) {
+    size_t hits = 0;
+    for (auto page_id : trace) {
+      hits += Access(page_id) ? 1 : 0;
+    }
+    return trace.empty() ? 0 : static_cast<double>(hits) / trace.size();
+  }
+
+  double HitRatio() const { return accesses_ == 0 ? 0 : static_cast<double>(hits_) / accesses_; }
+
+private:
+  Replacer *replacer_;
+  std::list<frame_id_t> free_list_;
+  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  std::unordered_map<frame_id_t, page_id_t> frame_page_;
+  size_t hits_{0};
+  size_t accesses_{0};
+};
+
+/**
+ * Point lookups on a small hot set (index upper levels, catalog pages) mixed with full scans of a large table.
+ * Every scan_interval point lookups, a full scan of scan_pages pages starting at page hot_pages is issued, during
+ * which one point lookup is issued every lookup_per_scan_page scanned pages.
+ */
+inline std::vector<page_id_t> MixedLookupScanTrace(page_id_t hot_pages, page_id_t scan_pages, size_t rounds,
+                                                   size_t scan_interval, size_t lookup_per_scan_page = 4) {
+  std::vector<page_id_t> trace;
+  size_t lookups = 0;
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < scan_interval; i++) {
+      trace.push_back((lookups++ * 7) % hot_pages);
+    }
+    for (page_id_t p = 0; p < scan_pages; p++) {
+      trace.push_back(hot_pages + p);
+      if (p % lookup_per_scan_page == 0) {
+        trace.push_back((lookups++ * 7) % hot_pages);
+      }
+    }
+  }
+  return trace;
+}
+
+/**
+ * Point lookups whose hot set moves: every phase_length lookups, the lookups go to the next hot_pages pages out of
+ * total_pages. A policy has to forget the old hot set to follow the new one.
+ */
+inline std::vector<page_id_t> ShiftingHotSetTrace(page_id_t hot_pages, page_id_t total_pages, size_t phases,
+                                                  size_t phase_length) {
+  std::vector<page_id_t> trace;
+  for (size_t phase = 0; phase < phases; phase++) {
+    page_id_t base = static_cast<page_id_t>((phase * hot_pages) % total_pages);
+    for (size_t i = 0; i < phase_length; i++) {
+      trace.push_back((base + static_cast<page_id_t>((i * 7) % hot_pages)) % total_pages);
+    }
+  }
+  return trace;
+}
+
+#endif //MINISQL_REPLACER_TRACE_H
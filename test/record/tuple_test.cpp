@@ -5,6 +5,7 @@
 #include "page/table_page.h"
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 char *chars[] = {const_cast<char *>(""), const_cast<char *>("hello"), const_cast<char *>("world!"),
@@ -104,6 +105,77 @@ TEST(TupleTest, RowTest) {
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
 }
 
+TEST(TupleTest, RowViewTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, true, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   ALLOC_COLUMN(heap)("nick", TypeId::kTypeChar, 64, 2, true, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 3, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char buffer[PAGE_SIZE];
+  RowView view;
+  // the fields are read in any order, after a null field and after a char field
+  std::vector<std::vector<Field>> rows = {
+      {Field(TypeId::kTypeInt, 188), Field(TypeId::kTypeChar, chars[1], strlen(chars[1]), false),
+       Field(TypeId::kTypeChar, chars[2], strlen(chars[2]), false), Field(TypeId::kTypeFloat, 19.99f)},
+      {Field(TypeId::kTypeInt), Field(TypeId::kTypeChar), Field(TypeId::kTypeChar, chars[0], 0, false),
+       Field(TypeId::kTypeFloat, -2.33f)}};
+  for (auto &fields : rows) {
+    Row row(fields);
+    row.SerializeTo(buffer, schema.get());
+    view.Reset(buffer, schema.get(), RowId(1, 2));
+    ASSERT_EQ(4, view.GetFieldCount());
+    EXPECT_EQ(RowId(1, 2), view.GetRowId());
+    for (int i = 3; i >= 0; i--) {
+      Field field = view.GetField(i);
+      EXPECT_EQ(fields[i].IsNull(), view.IsNull(i));
+      EXPECT_EQ(fields[i].IsNull(), field.IsNull());
+      if (!fields[i].IsNull()) {
+        EXPECT_EQ(CmpBool::kTrue, field.CompareEquals(fields[i]));
+      }
+    }
+    Row row2(view.GetRowId());
+    view.ToRow(&row2);
+    ASSERT_EQ(4, row2.GetFieldCount());
+    EXPECT_EQ(CmpBool::kTrue, row2.GetField(3)->CompareEquals(fields[3]));
+  }
+  // a char field is read in place
+  Row row(rows[0]);
+  row.SerializeTo(buffer, schema.get());
+  view.Reset(buffer, schema.get(), RowId(1, 2));
+  Field name = view.GetField(1);
+  EXPECT_TRUE(name.GetData() >= buffer && name.GetData() < buffer + PAGE_SIZE);
+}
+
+TEST(TupleTest, RowProjectionTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, true, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   ALLOC_COLUMN(heap)("nick", TypeId::kTypeChar, 64, 2, true, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 3, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188), Field(TypeId::kTypeChar),
+                               Field(TypeId::kTypeChar, chars[2], strlen(chars[2]), false),
+                               Field(TypeId::kTypeFloat, 19.99f)};
+  Row row(fields);
+  char buffer[PAGE_SIZE];
+  uint32_t size = row.SerializeTo(buffer, schema.get());
+  // the columns come in the order asked for, a column may be asked for twice
+  std::vector<std::vector<uint32_t>> projections = {{3, 0}, {2}, {1, 3, 1}, {}, {0, 1, 2, 3}};
+  for (auto &column_ids : projections) {
+    Row projected(RowId(1, 2));
+    ASSERT_EQ(size, projected.DeserializeFrom(buffer, schema.get(), column_ids));
+    ASSERT_EQ(column_ids.size(), projected.GetFieldCount());
+    for (size_t i = 0; i < column_ids.size(); i++) {
+      Field *field = projected.GetField(i);
+      ASSERT_EQ(fields[column_ids[i]].IsNull(), field->IsNull());
+      if (!field->IsNull()) {
+        EXPECT_EQ(CmpBool::kTrue, field->CompareEquals(fields[column_ids[i]]));
+      }
+    }
+  }
+}
+
 TEST(TupleTest, ColTest) {
   SimpleMemHeap heap;
   TablePage table_page;
@@ -0,0 +1,111 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "gtest/gtest.h"
+#include "storage/async_io_engine.h"
+#include "storage/disk_manager.h"
+
+TEST(AsyncIOEngineTest, ReadWriteTest) {
+  const std::string file_name = "async_io_test.db";
+  const size_t num_pages = 256;
+
+  for (bool use_io_uring : {true, false}) {
+    remove(file_name.c_str());
+    int fd = open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+    ASSERT_GE(fd, 0);
+    std::unique_ptr<AsyncIOEngine> engine = AsyncIOEngine::Create(16, 4, use_io_uring);
+
+    // Scenario: many writes are in flight, more than the queue depth.
+    std::vector<char> data(num_pages * PAGE_SIZE);
+    for (size_t i = 0; i < num_pages; i++) {
+      memset(data.data() + i * PAGE_SIZE, static_cast<int>('a' + i % 26), PAGE_SIZE);
+      snprintf(data.data() + i * PAGE_SIZE, PAGE_SIZE, "page %zu", i);
+    }
+    std::atomic<size_t> written{0};
+    for (size_t i = 0; i < num_pages; i++) {
+      engine->SubmitWrite(fd, data.data() + i * PAGE_SIZE, PAGE_SIZE, i * PAGE_SIZE, [&written](ssize_t result) {
+        EXPECT_EQ(PAGE_SIZE, result);
+        written++;
+      });
+    }
+    engine->Drain();
+    EXPECT_EQ(num_pages, written.load());
+
+    // Scenario: the reads come back in any order, each into its own buffer.
+    std::vector<char> read_back(num_pages * PAGE_SIZE, 0);
+    std::atomic<size_t> read{0};
+    for (size_t i = num_pages; i-- > 0;) {
+      engine->SubmitRead(fd, read_back.data() + i * PAGE_SIZE, PAGE_SIZE, i * PAGE_SIZE, [&read](ssize_t result) {
+        EXPECT_EQ(PAGE_SIZE, result);
+        read++;
+      });
+    }
+    engine->Drain();
+    EXPECT_EQ(num_pages, read.load());
+    EXPECT_EQ(0, memcmp(data.data(), read_back.data(), data.size()));
+
+    // Scenario: a read at the end of the file transfers what is there.
+    std::promise<ssize_t> eof;
+    char buf[PAGE_SIZE];
+    engine->SubmitRead(fd, buf, PAGE_SIZE, num_pages * PAGE_SIZE - 100,
+                       [&eof](ssize_t result) { eof.set_value(result); });
+    EXPECT_EQ(100, eof.get_future().get());
+
+    // Scenario: an error is reported to the callback.
+    std::promise<ssize_t> error;
+    engine->SubmitRead(-1, buf, PAGE_SIZE, 0, [&error](ssize_t result) { error.set_value(result); });
+    EXPECT_EQ(-EBADF, error.get_future().get());
+
+    engine.reset();
+    close(fd);
+  }
+  remove(file_name.c_str());
+}
+
+TEST(AsyncIOEngineTest, DiskManagerAsyncTest) {
+  const std::string db_name = "async_io_disk_test.db";
+  const page_id_t num_pages = 64;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Scenario: the pages are written and read back through the futures.
+  std::vector<char> data(num_pages * PAGE_SIZE);
+  std::vector<std::future<bool>> writes;
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    snprintf(data.data() + page_id * PAGE_SIZE, PAGE_SIZE, "page %d", page_id);
+    writes.push_back(disk_manager->WritePageAsync(page_id, data.data() + page_id * PAGE_SIZE));
+  }
+  for (auto &write : writes) {
+    EXPECT_TRUE(write.get());
+  }
+  std::vector<char> read_back(num_pages * PAGE_SIZE, 'x');
+  std::atomic<int> read{0};
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    disk_manager->ReadPageAsync(page_id, read_back.data() + page_id * PAGE_SIZE, [&read](bool ok) {
+      EXPECT_TRUE(ok);
+      read++;
+    });
+  }
+  disk_manager->WaitForAsyncIO();
+  EXPECT_EQ(num_pages, read.load());
+  EXPECT_EQ(0, memcmp(data.data(), read_back.data(), data.size()));
+
+  // Scenario: a page beyond the end of the file reads as zeros.
+  char buf[PAGE_SIZE];
+  memset(buf, 'x', PAGE_SIZE);
+  EXPECT_TRUE(disk_manager->ReadPageAsync(10 * num_pages, buf).get());
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[PAGE_SIZE - 1]);
+
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -1,4 +1,16 @@
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 #include "gtest/gtest.h"
 #include "storage/disk_manager.h"
 #include <iostream>
@@ -42,6 +54,145 @@ TEST(DiskManagerTest, BitMapPageTest) {
   ASSERT_FALSE(bitmap->AllocatePage(ofs));
 }
 
+TEST(DiskManagerTest, BitMapSummaryTest) {
+  using Bitmap = BitmapPage<PAGE_SIZE>;
+  const uint32_t num_pages = Bitmap::GetMaxSupportedSize();
+  char buf[PAGE_SIZE];
+  char summary_buf[PAGE_SIZE];
+  memset(buf, 0, PAGE_SIZE);
+  memset(summary_buf, 0, PAGE_SIZE);
+  Bitmap *bitmap = reinterpret_cast<Bitmap *>(buf);
+  Bitmap *summary_bitmap = reinterpret_cast<Bitmap *>(summary_buf);
+  Bitmap::Summary summary;
+  summary_bitmap->BuildSummary(&summary);
+
+  // Scenario: with or without the summary, the same pages are allocated, the first free page each time.
+  std::mt19937 rng(0);
+  std::vector<uint32_t> allocated;
+  uint32_t ofs;
+  uint32_t summary_ofs;
+  for (int round = 0; round < 20000; round++) {
+    if (allocated.size() < num_pages && (allocated.empty() || rng() % 3 != 0)) {
+      ASSERT_TRUE(bitmap->AllocatePage(ofs));
+      ASSERT_TRUE(summary_bitmap->AllocatePage(summary_ofs, &summary));
+      ASSERT_EQ(ofs, summary_ofs);
+      allocated.push_back(ofs);
+    } else {
+      size_t i = rng() % allocated.size();
+      ASSERT_TRUE(bitmap->DeAllocatePage(allocated[i]));
+      ASSERT_TRUE(summary_bitmap->DeAllocatePage(allocated[i], &summary));
+      ASSERT_FALSE(summary_bitmap->DeAllocatePage(allocated[i], &summary));
+      allocated[i] = allocated.back();
+      allocated.pop_back();
+    }
+  }
+  ASSERT_EQ(0, memcmp(buf, summary_buf, PAGE_SIZE));
+  uint32_t lowest_free = 0;
+  while (!bitmap->IsPageFree(lowest_free)) {
+    lowest_free++;
+  }
+  ASSERT_TRUE(summary_bitmap->AllocatePage(summary_ofs, &summary));
+  EXPECT_EQ(lowest_free, summary_ofs);
+
+  // Scenario: the last page of the extent, then a full extent.
+  while (summary_bitmap->AllocatePage(summary_ofs, &summary)) {
+  }
+  EXPECT_EQ(num_pages, summary_bitmap->page_allocated_);
+  ASSERT_TRUE(summary_bitmap->DeAllocatePage(num_pages - 1, &summary));
+  ASSERT_TRUE(summary_bitmap->AllocatePage(summary_ofs, &summary));
+  EXPECT_EQ(num_pages - 1, summary_ofs);
+  EXPECT_FALSE(summary_bitmap->AllocatePage(summary_ofs, &summary));
+}
+
+TEST(DiskManagerTest, BitMapFragmentedRefillTest) {
+  using Bitmap = BitmapPage<PAGE_SIZE>;
+  const uint32_t num_pages = Bitmap::GetMaxSupportedSize();
+
+  // Scenario: random pages of a full extent are freed, the refill finds exactly those pages, with or without
+  // the summary.
+  for (bool with_summary : {false, true}) {
+    char buf[PAGE_SIZE];
+    memset(buf, 0, PAGE_SIZE);
+    Bitmap *bitmap = reinterpret_cast<Bitmap *>(buf);
+    Bitmap::Summary summary;
+    Bitmap::Summary *use_summary = with_summary ? &summary : nullptr;
+    uint32_t ofs;
+    for (uint32_t i = 0; i < num_pages; i++) {
+      ASSERT_TRUE(bitmap->AllocatePage(ofs));
+    }
+    bitmap->BuildSummary(&summary);
+    std::mt19937 rng(0);
+    std::unordered_set<uint32_t> freed;
+    for (size_t round = 0; round < 8; round++) {
+      for (size_t i = 0; i < 16; i++) {
+        uint32_t page = rng() % num_pages;
+        if (bitmap->DeAllocatePage(page, use_summary)) {
+          freed.insert(page);
+        }
+      }
+      while (bitmap->page_allocated_ < num_pages) {
+        ASSERT_TRUE(bitmap->AllocatePage(ofs, use_summary));
+        EXPECT_EQ(1, freed.erase(ofs));
+      }
+      EXPECT_TRUE(freed.empty());
+      EXPECT_FALSE(bitmap->AllocatePage(ofs, use_summary));
+    }
+  }
+}
+
+// Compares the refill of a fragmented extent bit at a time, word at a time and with the summary, run with
+// --gtest_also_run_disabled_tests --gtest_filter=*BitMapMicroBenchmark.
+TEST(DiskManagerTest, DISABLED_BitMapMicroBenchmark) {
+  using Bitmap = BitmapPage<PAGE_SIZE>;
+  const uint32_t num_pages = Bitmap::GetMaxSupportedSize();
+  const size_t rounds = 2000;
+  const size_t freed_per_round = 16;
+
+  // a full extent where a few random pages are freed and allocated again every round: every round searches the
+  // whole bitmap, a fragmented extent.
+  auto run = [&](int mode) {
+    char buf[PAGE_SIZE];
+    memset(buf, 0, PAGE_SIZE);
+    Bitmap *bitmap = reinterpret_cast<Bitmap *>(buf);
+    Bitmap::Summary summary;
+    Bitmap::Summary *use_summary = mode == 2 ? &summary : nullptr;
+    uint32_t ofs;
+    for (uint32_t i = 0; i < num_pages; i++) {
+      bitmap->AllocatePage(ofs);
+    }
+    bitmap->BuildSummary(&summary);
+    std::mt19937 rng(0);
+    std::chrono::duration<double, std::nano> elapsed(0);
+    for (size_t r = 0; r < rounds; r++) {
+      for (size_t i = 0; i < freed_per_round; i++) {
+        bitmap->DeAllocatePage(rng() % num_pages, use_summary);
+      }
+      while (bitmap->page_allocated_ < num_pages) {
+        auto start = std::chrono::steady_clock::now();
+        if (mode == 0) {
+          // the search of the previous version, one IsPageFree call per page from next_free_page_.
+          ofs = bitmap->next_free_page_;
+          while (!bitmap->IsPageFree(ofs)) {
+            ofs++;
+          }
+          elapsed += std::chrono::steady_clock::now() - start;
+          bitmap->AllocatePage(ofs);
+        } else {
+          bitmap->AllocatePage(ofs, use_summary);
+          elapsed += std::chrono::steady_clock::now() - start;
+        }
+      }
+    }
+    return elapsed.count() / rounds;
+  };
+
+  double bit_ns = run(0);
+  double word_ns = run(1);
+  double summary_ns = run(2);
+  std::cout << "cost to refill a fragmented extent: bit at a time " << bit_ns << " ns, word at a time " << word_ns
+            << " ns, word at a time with summary " << summary_ns << " ns" << std::endl;
+}
+
 TEST(DiskManagerTest, DiskManagerTest) {
   std::string db_name = "disk_test.db";
   DiskManager *disk_mgr = new DiskManager(db_name);
@@ -71,4 +222,316 @@ TEST(DiskManagerTest, DiskManagerTest) {
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
   remove(db_name.c_str());
-}
\ No newline at end of file
+}
+TEST(DiskManagerTest, AllocationPersistenceTest) {
+  std::string db_name = "disk_alloc_test.db";
+  const page_id_t num_pages = DiskManager::BITMAP_SIZE + 10;
+  remove(db_name.c_str());
+  DiskManager *disk_mgr = new DiskManager(db_name);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+  }
+  disk_mgr->DeAllocatePage(5);
+  disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE + 3);
+  disk_mgr->Close();
+  delete disk_mgr;
+
+  // Scenario: the bitmaps and the meta page are written at close, the allocations are found again after a restart.
+  auto check = [&](DiskManager *disk_mgr) {
+    DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+    EXPECT_EQ(2, meta_page->GetExtentNums());
+    EXPECT_EQ(num_pages - 2, meta_page->GetAllocatedPages());
+    EXPECT_EQ(DiskManager::BITMAP_SIZE - 1, meta_page->GetExtentUsedPage(0));
+    EXPECT_EQ(9, meta_page->GetExtentUsedPage(1));
+    EXPECT_TRUE(disk_mgr->IsPageFree(5));
+    EXPECT_FALSE(disk_mgr->IsPageFree(6));
+    EXPECT_TRUE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE + 3));
+    // the first extent which is not full is used first
+    EXPECT_EQ(5, disk_mgr->AllocatePage());
+    EXPECT_EQ(DiskManager::BITMAP_SIZE + 3, disk_mgr->AllocatePage());
+    EXPECT_EQ(num_pages, disk_mgr->AllocatePage());
+  };
+  disk_mgr = new DiskManager(db_name);
+  check(disk_mgr);
+  // not written, checked again below
+  disk_mgr->DeAllocatePage(5);
+  disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE + 3);
+  disk_mgr->DeAllocatePage(num_pages);
+  disk_mgr->FlushMetaData();
+
+  // Scenario: a file written without its meta page gets the meta page rebuilt from the bitmaps.
+  char zeros[PAGE_SIZE];
+  memset(zeros, 0, PAGE_SIZE);
+  std::fstream file(db_name, std::ios::binary | std::ios::in | std::ios::out);
+  file.write(zeros, PAGE_SIZE);
+  file.close();
+  delete disk_mgr;
+  disk_mgr = new DiskManager(db_name);
+  check(disk_mgr);
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AllocationHintTest) {
+  std::string db_name = "disk_hint_test.db";
+  remove(db_name.c_str());
+  DiskManager *disk_mgr = new DiskManager(db_name);
+  const int pages_per_object = 200;
+  ASSERT_EQ(0, disk_mgr->AllocatePage());
+
+  // Scenario: two objects grow at the same time, each asks for its pages near its last page.
+  std::vector<page_id_t> chains[2];
+  chains[0].push_back(disk_mgr->AllocatePage());
+  chains[1].push_back(disk_mgr->AllocatePage());
+  for (int i = 1; i < pages_per_object; i++) {
+    for (auto &chain : chains) {
+      chain.push_back(disk_mgr->AllocatePage(chain.back()));
+    }
+  }
+  // the chains are made of runs of contiguous pages, one new run every 64 pages at most.
+  for (auto &chain : chains) {
+    int jumps = 0;
+    for (size_t i = 1; i < chain.size(); i++) {
+      ASSERT_FALSE(disk_mgr->IsPageFree(chain[i]));
+      if (chain[i] != chain[i - 1] + 1) {
+        jumps++;
+      }
+    }
+    EXPECT_LE(jumps, pages_per_object / 64 + 2);
+  }
+
+  // Scenario: without a hint, the first free page is still taken.
+  disk_mgr->DeAllocatePage(chains[0][10]);
+  EXPECT_EQ(chains[0][10], disk_mgr->AllocatePage());
+  // the page after the neighbour is taken if it is free.
+  disk_mgr->DeAllocatePage(chains[1][20]);
+  EXPECT_EQ(chains[1][20], disk_mgr->AllocatePage(chains[1][20] - 1));
+  // the neighbour is the last page of the last extent, no page near it: the first free page.
+  page_id_t first_free = 0;
+  while (!disk_mgr->IsPageFree(first_free)) {
+    first_free++;
+  }
+  EXPECT_EQ(first_free, disk_mgr->AllocatePage(static_cast<page_id_t>(DiskManager::BITMAP_SIZE - 1)));
+
+  disk_mgr->Close();
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+/**
+ * @return the number of extents of the file on disk, 0 if the file system can not tell
+ */
+static uint32_t CountFileExtents(const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  struct fiemap fiemap;
+  memset(&fiemap, 0, sizeof(fiemap));
+  fiemap.fm_length = FIEMAP_MAX_OFFSET;
+  fiemap.fm_flags = FIEMAP_FLAG_SYNC;
+  uint32_t extents = ioctl(fd, FS_IOC_FIEMAP, &fiemap) == 0 ? fiemap.fm_mapped_extents : 0;
+  close(fd);
+  return extents;
+}
+
+TEST(DiskManagerTest, FileGrowthTest) {
+  const std::string db_name = "disk_growth_test.db";
+  const page_id_t num_pages = 200;
+
+  // Scenario: the file grows a page or a chunk at a time, the preallocation does not change the size of the file and
+  // the pages are read back after a restart.
+  for (size_t chunk_pages : {static_cast<size_t>(0), static_cast<size_t>(64)}) {
+    remove(db_name.c_str());
+    auto *disk_mgr = new DiskManager(db_name);
+    disk_mgr->SetGrowthChunk(chunk_pages);
+    char data[PAGE_SIZE];
+    for (page_id_t i = 0; i < num_pages; i++) {
+      page_id_t page_id = disk_mgr->AllocatePage(i == 0 ? INVALID_PAGE_ID : i - 1);
+      ASSERT_EQ(i, page_id);
+      memset(data, 'a' + i % 26, PAGE_SIZE);
+      disk_mgr->WritePage(page_id, data);
+    }
+    delete disk_mgr;
+    struct stat stat_buf;
+    ASSERT_EQ(0, stat(db_name.c_str(), &stat_buf));
+    EXPECT_GE(stat_buf.st_size, (num_pages + 2) * PAGE_SIZE);
+    EXPECT_LT(stat_buf.st_size, (num_pages + 3) * PAGE_SIZE);
+
+    disk_mgr = new DiskManager(db_name);
+    for (page_id_t i = 0; i < num_pages; i++) {
+      disk_mgr->ReadPage(i, data);
+      EXPECT_EQ(static_cast<char>('a' + i % 26), data[0]);
+      EXPECT_EQ(static_cast<char>('a' + i % 26), data[PAGE_SIZE - 1]);
+    }
+    delete disk_mgr;
+  }
+  remove(db_name.c_str());
+}
+
+// Compares the throughput and the fragmentation of two files growing side by side a page or a chunk at a time. The
+// files are synced, run it with --gtest_also_run_disabled_tests --gtest_filter=*FileGrowthBenchmark.
+TEST(DiskManagerTest, DISABLED_FileGrowthBenchmark) {
+  const std::string db_names[2] = {"disk_growth_test_1.db", "disk_growth_test_2.db"};
+  const page_id_t num_pages = 4096;
+
+  // two tables loaded at the same time, each in its own db file: the files grow side by side, and are synced every
+  // sync_pages pages as a checkpoint would.
+  const page_id_t sync_pages = 256;
+  auto run = [&](size_t chunk_pages, uint32_t *extents) {
+    DiskManager *disk_mgrs[2];
+    for (int i = 0; i < 2; i++) {
+      remove(db_names[i].c_str());
+      disk_mgrs[i] = new DiskManager(db_names[i]);
+      disk_mgrs[i]->SetGrowthChunk(chunk_pages);
+    }
+    char data[PAGE_SIZE];
+    memset(data, 'x', PAGE_SIZE);
+    auto start = std::chrono::steady_clock::now();
+    for (page_id_t i = 0; i < num_pages; i++) {
+      for (auto disk_mgr : disk_mgrs) {
+        page_id_t page_id = disk_mgr->AllocatePage(i == 0 ? INVALID_PAGE_ID : i - 1);
+        EXPECT_EQ(i, page_id);
+        disk_mgr->WritePage(page_id, data);
+      }
+      if ((i + 1) % sync_pages == 0) {
+        for (auto &db_name : db_names) {
+          int fd = open(db_name.c_str(), O_RDONLY);
+          fsync(fd);
+          close(fd);
+        }
+      }
+    }
+    *extents = 0;
+    for (int i = 0; i < 2; i++) {
+      delete disk_mgrs[i];
+      int fd = open(db_names[i].c_str(), O_RDONLY);
+      fsync(fd);
+      close(fd);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    for (int i = 0; i < 2; i++) {
+      // the preallocation does not change the size of the file.
+      struct stat stat_buf;
+      stat(db_names[i].c_str(), &stat_buf);
+      EXPECT_GE(stat_buf.st_size, (num_pages + 2) * PAGE_SIZE);
+      EXPECT_LT(stat_buf.st_size, (num_pages + 3) * PAGE_SIZE);
+      *extents += CountFileExtents(db_names[i]);
+      remove(db_names[i].c_str());
+    }
+    // MB written per second
+    return 2.0 * num_pages * PAGE_SIZE / elapsed.count() / (1 << 20);
+  };
+
+  uint32_t page_extents;
+  uint32_t chunk_extents;
+  double page_mb = run(0, &page_extents);
+  double chunk_mb = run(FILE_GROWTH_CHUNK_PAGES, &chunk_extents);
+  std::cout << "growth one page at a time: " << page_mb << " MB/s, " << page_extents << " extents on disk; "
+            << "growth " << FILE_GROWTH_CHUNK_PAGES << " pages at a time: " << chunk_mb << " MB/s, " << chunk_extents
+            << " extents on disk" << std::endl;
+}
+
+TEST(DiskManagerTest, ConcurrentPageIOTest) {
+  std::string db_name = "disk_io_test.db";
+  const int num_threads = 4;
+  const int pages_per_thread = 64;
+
+  for (DiskIOBackend backend : {kDiskIOStream, kDiskIOPositioned}) {
+    remove(db_name.c_str());
+    DiskManager *disk_mgr = new DiskManager(db_name, backend);
+
+    // Scenario: a page beyond the end of the file reads as zeros.
+    char data[PAGE_SIZE];
+    memset(data, 'x', PAGE_SIZE);
+    disk_mgr->ReadPage(100, data);
+    EXPECT_EQ(0, data[0]);
+    EXPECT_EQ(0, data[PAGE_SIZE - 1]);
+
+    // Scenario: the threads write and read their own pages at the same time.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([disk_mgr, t] {
+        char buf[PAGE_SIZE];
+        for (int i = 0; i < pages_per_thread; i++) {
+          page_id_t page_id = i * num_threads + t;
+          memset(buf, 'a' + (page_id % 26), PAGE_SIZE);
+          snprintf(buf, PAGE_SIZE, "page %d", page_id);
+          disk_mgr->WritePage(page_id, buf);
+        }
+        for (int i = 0; i < pages_per_thread; i++) {
+          page_id_t page_id = i * num_threads + t;
+          disk_mgr->ReadPage(page_id, buf);
+          char expected[32];
+          snprintf(expected, sizeof(expected), "page %d", page_id);
+          EXPECT_EQ(0, strcmp(buf, expected));
+          EXPECT_EQ('a' + (page_id % 26), buf[PAGE_SIZE - 1]);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    disk_mgr->Close();
+    delete disk_mgr;
+
+    // Scenario: the pages are found again after a restart.
+    disk_mgr = new DiskManager(db_name, backend);
+    for (page_id_t page_id = 0; page_id < num_threads * pages_per_thread; page_id++) {
+      disk_mgr->ReadPage(page_id, data);
+      char expected[32];
+      snprintf(expected, sizeof(expected), "page %d", page_id);
+      EXPECT_EQ(0, strcmp(data, expected));
+    }
+    disk_mgr->Close();
+    delete disk_mgr;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, BatchedWriteTest) {
+  std::string db_name = "disk_batch_test.db";
+  // a run longer than one vectored write, a gap, and a run across the bitmap page of the second extent.
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = 0; page_id < 1100; page_id++) {
+    page_ids.push_back(page_id);
+  }
+  page_ids.push_back(1200);
+  for (page_id_t page_id = DiskManager::BITMAP_SIZE - 2; page_id < static_cast<page_id_t>(DiskManager::BITMAP_SIZE) + 2;
+       page_id++) {
+    page_ids.push_back(page_id);
+  }
+  std::vector<std::vector<char>> pages;
+  for (auto page_id : page_ids) {
+    pages.emplace_back(PAGE_SIZE, 'a' + (page_id % 26));
+    snprintf(pages.back().data(), PAGE_SIZE, "page %d", page_id);
+  }
+
+  for (DiskIOBackend backend : {kDiskIOStream, kDiskIOPositioned}) {
+    remove(db_name.c_str());
+    DiskManager *disk_mgr = new DiskManager(db_name, backend);
+    // Scenario: the pages are given in any order.
+    std::vector<DiskManager::PageWrite> writes;
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      writes.push_back({page_ids[i], pages[i].data()});
+    }
+    std::shuffle(writes.begin(), writes.end(), std::default_random_engine(0));
+    disk_mgr->WritePages(&writes);
+    disk_mgr->Sync();
+    for (size_t i = 1; i < writes.size(); i++) {
+      EXPECT_LT(writes[i - 1].logical_page_id_, writes[i].logical_page_id_);
+    }
+    disk_mgr->Close();
+    delete disk_mgr;
+
+    // Scenario: every page is at its place, the pages after the bitmap page of the second extent are not shifted.
+    disk_mgr = new DiskManager(db_name, backend);
+    char data[PAGE_SIZE];
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      disk_mgr->ReadPage(page_ids[i], data);
+      EXPECT_EQ(0, memcmp(pages[i].data(), data, PAGE_SIZE));
+    }
+    disk_mgr->ReadPage(1100, data);
+    EXPECT_EQ(0, data[0]);
+    disk_mgr->Close();
+    delete disk_mgr;
+  }
+  remove(db_name.c_str());
+}
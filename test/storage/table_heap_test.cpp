@@ -1,5 +1,10 @@
-#include <vector>
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
@@ -85,10 +90,12 @@ TEST(TableHeapTest, TableHeapApplyDeleteTest) {
   }
 
   // Deletion Half size of Tuple in the TableHeap
-  TableIterator iter = table_heap->Begin(nullptr);
-  int i;
-  for (i = 0; i < row_nums/2; i++, iter++) {
-    table_heap->ApplyDelete(iter->GetRowId(), nullptr);
+  {
+    // the iterator pins its page, it is gone before the heap is freed
+    TableIterator iter = table_heap->Begin(nullptr);
+    for (int i = 0; i < row_nums / 2; i++, iter++) {
+      table_heap->ApplyDelete(iter->GetRowId(), nullptr);
+    }
   }
   //std::cout << row_values.size() << endl;
   ASSERT_EQ(row_nums/2, row_values.size());
@@ -137,22 +144,22 @@ TEST(TableHeapTest, TableHeapUpdateTest) {
   }
 
   //Update Tuple in the TableHeap
-  TableIterator iter = table_heap->Begin(nullptr);
-  int i;
-  for ( i = 0; i < row_nums; i++,iter++) {
-   
-    int32_t len = RandomUtils::RandomInt(0, 64);
-    char *characters = new char[len];
-    RandomUtils::RandomString(characters, len);
-    Fields *fields =
-        new Fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(characters), len, true),
-                   Field(TypeId::kTypeFloat, RandomUtils::RandomFloat(-999.f, 999.f))};
+  {
+    TableIterator iter = table_heap->Begin(nullptr);
+    for (int i = 0; i < row_nums; i++, iter++) {
+      int32_t len = RandomUtils::RandomInt(0, 64);
+      char *characters = new char[len];
+      RandomUtils::RandomString(characters, len);
+      Fields *fields =
+          new Fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(characters), len, true),
+                     Field(TypeId::kTypeFloat, RandomUtils::RandomFloat(-999.f, 999.f))};
 
-    Row row(*fields);
-    table_heap->UpdateTuple(row, iter->GetRowId(), nullptr);
-    row_values[row.GetRowId().Get()] = fields;
-   // std::cout << row.GetRowId().GetPageId() << " : " << row.GetRowId().GetSlotNum() << endl;
-    delete[] characters;
+      Row row(*fields);
+      table_heap->UpdateTuple(row, iter->GetRowId(), nullptr);
+      row_values[row.GetRowId().Get()] = fields;
+      // std::cout << row.GetRowId().GetPageId() << " : " << row.GetRowId().GetSlotNum() << endl;
+      delete[] characters;
+    }
   }
  
   ASSERT_EQ(row_nums, row_values.size());
@@ -226,3 +233,287 @@ TEST(TableHeapTest, TableHeapIteratorTest) {
   table_heap->FreeHeap();
   //std::cout << "Success" << endl;
 }
+
+TEST(TableHeapTest, TableHeapFreeSpaceMapTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 5000;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 512, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'x', sizeof(characters));
+  // every row takes the same room.
+  auto insert_row = [&](TableHeap *table_heap, int i) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), true)};
+    Row row(fields);
+    EXPECT_TRUE(table_heap->InsertTuple(row, nullptr));
+    return row.GetRowId();
+  };
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  ASSERT_NE(INVALID_PAGE_ID, table_heap->GetFreeSpaceMapPageId());
+  std::unordered_map<page_id_t, std::vector<RowId>> rows_of_page;
+  BufferPoolStats before;
+  for (int i = 0; i < row_nums; i++) {
+    if (i == row_nums - 100) {
+      before = engine.bpm_->GetStats();
+    }
+    RowId rid = insert_row(table_heap, i);
+    rows_of_page[rid.GetPageId()].push_back(rid);
+  }
+  // Scenario: an insert into a large table does not try the pages one after another.
+  BufferPoolStats after = engine.bpm_->GetStats();
+  size_t fetches = after.fetch_hits_ + after.fetch_misses_ - before.fetch_hits_ - before.fetch_misses_;
+  EXPECT_GT(rows_of_page.size(), 50);
+  EXPECT_LE(fetches, 100 * 6);
+
+  // Scenario: the room freed by the deletes of a page in the middle of the heap is found by the next inserts.
+  size_t num_pages = rows_of_page.size();
+  page_id_t middle_page_id = std::next(rows_of_page.begin(), num_pages / 2)->first;
+  std::vector<RowId> freed = rows_of_page[middle_page_id];
+  for (auto &rid : freed) {
+    ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+    table_heap->ApplyDelete(rid, nullptr);
+  }
+  for (size_t i = 0; i < freed.size(); i++) {
+    EXPECT_EQ(middle_page_id, insert_row(table_heap, row_nums + i).GetPageId());
+  }
+
+  // Scenario: the map is found again by a heap loaded from its first page, and an update which moves a row frees
+  // its room.
+  TableHeap *loaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), schema.get(), nullptr, nullptr,
+                                        &heap, table_heap->GetFreeSpaceMapPageId());
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  RowId moved = rows_of_page[first_page_id].front();
+  table_heap->ApplyDelete(rows_of_page[first_page_id].back(), nullptr);
+  EXPECT_EQ(first_page_id, insert_row(loaded, -1).GetPageId());
+  char longer[512];
+  memset(longer, 'y', sizeof(longer));
+  Fields fields{Field(TypeId::kTypeInt, 0), Field(TypeId::kTypeChar, longer, sizeof(longer), true)};
+  Row updated(fields);
+  ASSERT_TRUE(loaded->UpdateTuple(updated, moved, nullptr));
+  EXPECT_NE(first_page_id, updated.GetRowId().GetPageId());
+  EXPECT_EQ(first_page_id, insert_row(loaded, -2).GetPageId());
+
+  // Scenario: the pages of the map are freed with the heap.
+  page_id_t free_space_map_page_id = table_heap->GetFreeSpaceMapPageId();
+  table_heap->FreeHeap();
+  EXPECT_TRUE(engine.bpm_->IsPageFree(free_space_map_page_id));
+  EXPECT_TRUE(engine.bpm_->IsPageFree(middle_page_id));
+}
+
+TEST(TableHeapTest, TableHeapInsertTuplesTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 20000;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, VARCHAR_MAX_LEN, 1, true, false),
+                                   ALLOC_COLUMN(heap)("note", TypeId::kTypeChar, VARCHAR_MAX_LEN, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<Row> rows;
+  rows.reserve(row_nums);
+  for (int i = 0; i < row_nums; i++) {
+    std::string name = "name " + std::to_string(i);
+    Fields fields{Field(TypeId::kTypeInt, i),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                  Field(TypeId::kTypeChar, const_cast<char *>(""), 0, true)};
+    rows.emplace_back(fields);
+  }
+
+  // one row at a time
+  TableHeap *one_by_one = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  BufferPoolStats start_stats = engine.bpm_->GetStats();
+  for (auto &row : rows) {
+    ASSERT_TRUE(one_by_one->InsertTuple(row, nullptr));
+  }
+  BufferPoolStats one_by_one_stats = engine.bpm_->GetStats();
+  std::unordered_set<page_id_t> one_by_one_pages;
+  for (auto &row : rows) {
+    one_by_one_pages.insert(row.GetRowId().GetPageId());
+  }
+
+  // Scenario: the batch fills the pages as densely as the inserts one at a time, and every row gets its rid.
+  TableHeap *batched = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  ASSERT_TRUE(batched->InsertTuples(rows, nullptr));
+  BufferPoolStats batched_stats = engine.bpm_->GetStats();
+  std::unordered_set<page_id_t> batched_pages;
+  for (int i = 0; i < row_nums; i++) {
+    Row row(rows[i].GetRowId());
+    ASSERT_TRUE(batched->GetTuple(&row, nullptr));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+    batched_pages.insert(rows[i].GetRowId().GetPageId());
+  }
+  EXPECT_EQ(one_by_one_pages.size(), batched_pages.size());
+  size_t one_by_one_fetches = one_by_one_stats.fetch_hits_ + one_by_one_stats.fetch_misses_ -
+                              start_stats.fetch_hits_ - start_stats.fetch_misses_;
+  size_t batched_fetches = batched_stats.fetch_hits_ + batched_stats.fetch_misses_ - one_by_one_stats.fetch_hits_ -
+                           one_by_one_stats.fetch_misses_;
+  // a few fetches per page: the pages of the map, the appended page and its previous page.
+  EXPECT_LE(batched_fetches, batched_pages.size() * 10);
+  EXPECT_LT(batched_fetches, one_by_one_fetches);
+
+  // Scenario: nothing is inserted if a row of the batch is too large.
+  char large[VARCHAR_MAX_LEN - 1];
+  memset(large, 'x', sizeof(large));
+  Fields large_fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, large, sizeof(large), true),
+                      Field(TypeId::kTypeChar, large, sizeof(large), true)};
+  std::vector<Row> too_large;
+  too_large.emplace_back(rows[0]);
+  too_large.emplace_back(large_fields);
+  EXPECT_FALSE(batched->InsertTuples(too_large, nullptr));
+  EXPECT_EQ(rows[0].GetRowId().Get(), too_large[0].GetRowId().Get());
+  one_by_one->FreeHeap();
+  batched->FreeHeap();
+}
+
+TEST(TableHeapTest, TableHeapRowViewScanTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 20000;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   ALLOC_COLUMN(heap)("note", TypeId::kTypeChar, 64, 2, true, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 3, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<Row> rows;
+  rows.reserve(row_nums);
+  for (int i = 0; i < row_nums; i++) {
+    std::string name = "name " + std::to_string(i);
+    Fields fields{Field(TypeId::kTypeInt, i),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                  Field(TypeId::kTypeFloat, static_cast<float>(i))};
+    rows.emplace_back(fields);
+  }
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  ASSERT_TRUE(table_heap->InsertTuples(rows, nullptr));
+
+  // Scenario: a predicate on the last column finds the same rows through the view as through the deserialized rows.
+  Field bound(TypeId::kTypeFloat, static_cast<float>(row_nums / 4));
+  std::vector<RowId> by_row, by_view;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    if (iter->GetField(3)->CompareLessThan(bound) == CmpBool::kTrue) {
+      by_row.push_back(iter->GetRowId());
+    }
+  }
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    if (iter.View().GetField(3).CompareLessThan(bound) == CmpBool::kTrue) {
+      by_view.push_back(iter.View().GetRowId());
+    }
+  }
+  ASSERT_EQ(static_cast<size_t>(row_nums / 4), by_view.size());
+  EXPECT_EQ(by_row, by_view);
+
+  // Scenario: a char field read through the view compares with the value inserted.
+  {
+    auto iter = table_heap->Begin(nullptr);
+    Row first(iter.View().GetRowId());
+    iter.View().ToRow(&first);
+    EXPECT_EQ(CmpBool::kTrue, iter.View().GetField(2).CompareEquals(*first.GetField(1)));
+    EXPECT_EQ(CmpBool::kTrue, iter->GetField(2)->CompareEquals(*first.GetField(2)));
+  }
+  table_heap->FreeHeap();
+}
+
+TEST(TableHeapTest, TableHeapProjectedGetTupleTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 20000;
+  std::vector<Column *> columns;
+  for (uint32_t i = 0; i < 8; i++) {
+    columns.push_back(ALLOC_COLUMN(heap)("c" + std::to_string(i), TypeId::kTypeChar, 32, i, true, false));
+  }
+  columns.push_back(ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 8, false, false));
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<Row> rows;
+  rows.reserve(row_nums);
+  for (int i = 0; i < row_nums; i++) {
+    std::string value = "value " + std::to_string(i);
+    Fields fields;
+    for (uint32_t j = 0; j < 8; j++) {
+      fields.emplace_back(TypeId::kTypeChar, const_cast<char *>(value.c_str()), value.size(), true);
+    }
+    fields.emplace_back(TypeId::kTypeInt, i);
+    rows.emplace_back(fields);
+  }
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  ASSERT_TRUE(table_heap->InsertTuples(rows, nullptr));
+
+  // Scenario: the projected read gives the columns asked for, in their order, and only them.
+  std::vector<uint32_t> column_ids{8, 0};
+  for (int i = 0; i < row_nums; i++) {
+    Row row(rows[i].GetRowId());
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr, &column_ids));
+    ASSERT_EQ(2, row.GetFieldCount());
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(*rows[i].GetField(8)));
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(*rows[i].GetField(0)));
+  }
+
+  // Scenario: the scan reads the same projection out of the view.
+  int scanned = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter, scanned++) {
+    Row row(iter.View().GetRowId());
+    iter.View().ToRow(&row, &column_ids);
+    ASSERT_EQ(2, row.GetFieldCount());
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(*iter->GetField(8)));
+  }
+  EXPECT_EQ(row_nums, scanned);
+  table_heap->FreeHeap();
+}
+
+TEST(TableHeapTest, TableHeapReadOnlyTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name = "name";
+  Fields fields{Field(TypeId::kTypeInt, 1),
+                Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+  RowId rid;
+  {
+    DBStorageEngine engine(db_file_name);
+    TableInfo *table_info = nullptr;
+    ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateTable("t", schema.get(), nullptr, table_info));
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+    rid = row.GetRowId();
+  }
+  std::string warm_file_name = db_file_name + ".warm";
+  ASSERT_EQ(0, access(warm_file_name.c_str(), F_OK));
+
+  // Scenario: on a read only db file the DML fails, and the reads still work.
+  {
+    DBStorageEngine engine(db_file_name, false, DEFAULT_BUFFER_POOL_SIZE, DEFAULT_BUFFER_POOL_INSTANCES, true);
+    TableInfo *table_info = nullptr;
+    ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->GetTable("t", table_info));
+    TableHeap *table_heap = table_info->GetTableHeap();
+    Row row(fields);
+    EXPECT_FALSE(table_heap->InsertTuple(row, nullptr));
+    std::vector<Row> rows;
+    rows.emplace_back(fields);
+    EXPECT_FALSE(table_heap->InsertTuples(rows, nullptr));
+    EXPECT_FALSE(table_heap->UpdateTuple(row, rid, nullptr));
+    EXPECT_FALSE(table_heap->MarkDelete(rid, nullptr));
+    table_heap->ApplyDelete(rid, nullptr);
+    EXPECT_EQ(DB_FAILED, engine.catalog_mgr_->CreateTable("t2", schema.get(), nullptr, table_info));
+    EXPECT_EQ(DB_FAILED, engine.catalog_mgr_->DropTable("t"));
+    Row read(rid);
+    ASSERT_TRUE(table_heap->GetTuple(&read, nullptr));
+    EXPECT_EQ(CmpBool::kTrue, read.GetField(0)->CompareEquals(fields[0]));
+  }
+
+  // Scenario: nothing reached the file, and the warm up list of the writer is left in place.
+  EXPECT_EQ(0, access(warm_file_name.c_str(), F_OK));
+  DBStorageEngine engine(db_file_name, false);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->GetTable("t", table_info));
+  EXPECT_EQ(DB_TABLE_NOT_EXIST, engine.catalog_mgr_->GetTable("t2", table_info));
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->GetTable("t", table_info));
+  int count = 0;
+  for (auto iter = table_info->GetTableHeap()->Begin(nullptr); iter != table_info->GetTableHeap()->End(); ++iter) {
+    EXPECT_EQ(rid, iter.View().GetRowId());
+    EXPECT_EQ(CmpBool::kTrue, iter.View().GetField(1).CompareEquals(fields[1]));
+    count++;
+  }
+  EXPECT_EQ(1, count);
+}